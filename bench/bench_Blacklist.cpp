@@ -0,0 +1,77 @@
+#include <benchmark/benchmark.h>
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include "Blacklist.hpp"
+
+namespace {
+
+// state.range(0) случайных IMSI одной сети плюс несколько префиксов
+// разной длины, как в реальных списках
+pgw::Blacklist make_blacklist(size_t count) {
+    pgw::Blacklist blacklist;
+    uint64_t x = 88172645463325252ull;
+    for (size_t i = 0; i < count; ++i) {
+        x ^= x << 13; x ^= x >> 7; x ^= x << 17;
+        blacklist.add("25001" + std::to_string(1000000000 + x % 9000000000ull));
+    }
+    blacklist.add("46000*");
+    blacklist.add("3102601*");
+    blacklist.add("00101012*");
+    blacklist.build();
+    return blacklist;
+}
+
+// IMSI той же сети, что и записи списка: бинарный поиск без фильтра
+// здесь честно проходит все уровни
+pgw::Imsi imsi_for(uint64_t n) {
+    return *pgw::Imsi::parse("25001" + std::to_string(1000000000 + n % 9000000000ull));
+}
+
+} // namespace
+
+// типичный случай: IMSI нет в списке, ответ дает фильтр Блума
+static void BM_BlacklistMiss(benchmark::State& state) {
+    const auto blacklist = make_blacklist(state.range(0));
+    std::vector<pgw::Imsi> imsis;
+    for (uint64_t i = 0; i < 4096; ++i) imsis.push_back(imsi_for(i * 7919 + 1));
+    
+    size_t i = 0;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(blacklist.contains(imsis[i++ & 4095]));
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_BlacklistMiss)->RangeMultiplier(100)->Range(100, 1000000);
+
+// IMSI под префиксом: фильтр и бинарный поиск по префиксам
+static void BM_BlacklistPrefixHit(benchmark::State& state) {
+    const auto blacklist = make_blacklist(state.range(0));
+    const pgw::Imsi imsi("460001234567890");
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(blacklist.contains(imsi));
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_BlacklistPrefixHit)->Arg(1000000);
+
+// загрузка файла из state.range(0) строк
+static void BM_BlacklistLoadFile(benchmark::State& state) {
+    const std::string path = "/tmp/pgw_bench_blacklist.txt";
+    {
+        std::ofstream file(path);
+        for (int64_t i = 0; i < state.range(0); ++i) {
+            file << "25001" << (1000000000 + i * 7) << '\n';
+        }
+    }
+    for (auto _ : state) {
+        pgw::Blacklist blacklist;
+        blacklist.load_file(path, state.range(1));
+        blacklist.build();
+        benchmark::DoNotOptimize(blacklist.exact_count());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+    std::remove(path.c_str());
+}
+BENCHMARK(BM_BlacklistLoadFile)->ArgNames({"lines", "threads"})
+    ->Args({1000000, 1})->Args({1000000, 0})->Unit(benchmark::kMillisecond)->UseRealTime();
@@ -0,0 +1,38 @@
+#include <benchmark/benchmark.h>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include "CDRLogger.hpp"
+
+namespace {
+
+std::unique_ptr<pgw::CDRLogger> g_logger;
+const std::string kCdrFile = "/tmp/pgw_bench_cdr.log";
+
+} // namespace
+
+// постановка записи в очередь; в режиме block это устойчивая пропускная
+// способность вместе с потоком записи, state.range(0) - формат (0 - CSV, 1 - бинарный)
+static void BM_CdrLog(benchmark::State& state) {
+    if (state.thread_index() == 0) {
+        std::remove(kCdrFile.c_str());
+        pgw::CdrOptions options;
+        options.block_when_full = true;
+        options.format = state.range(0) ? pgw::CdrFormat::BINARY : pgw::CdrFormat::CSV;
+        g_logger = std::make_unique<pgw::CDRLogger>(kCdrFile, options);
+    }
+    
+    const pgw::Imsi imsi("001010123456780");
+    for (auto _ : state) {
+        g_logger->log(imsi, pgw::CdrAction::CREATED);
+    }
+    state.SetItemsProcessed(state.iterations());
+    
+    if (state.thread_index() == 0) {
+        g_logger->flush();
+        state.counters["dropped"] = g_logger->dropped();
+        g_logger.reset();
+        std::remove(kCdrFile.c_str());
+    }
+}
+BENCHMARK(BM_CdrLog)->ArgName("binary")->Arg(0)->Arg(1)->ThreadRange(1, 8)->UseRealTime();
@@ -0,0 +1,41 @@
+#include <benchmark/benchmark.h>
+#include <string>
+#include "Gtpv2.hpp"
+
+namespace {
+
+std::string make_csr() {
+    char buffer[128];
+    pgw::GtpWriter writer(buffer, sizeof(buffer), pgw::GtpMessageType::CREATE_SESSION_REQUEST, 0u, 1);
+    writer.add_imsi(pgw::Imsi("001010123456789"));
+    writer.add_fteid(0, 6, 0x11223344, 0x0100007F);
+    return std::string(writer.finish());
+}
+
+} // namespace
+
+// разбор Create Session Request и извлечение IMSI и Sender F-TEID
+static void BM_GtpParseCreateSession(benchmark::State& state) {
+    const std::string packet = make_csr();
+    for (auto _ : state) {
+        auto message = pgw::GtpMessage::parse(packet);
+        benchmark::DoNotOptimize(message->imsi());
+        benchmark::DoNotOptimize(message->fteid_teid(0));
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_GtpParseCreateSession);
+
+static void BM_GtpBuildCreateSessionResponse(benchmark::State& state) {
+    char buffer[128];
+    uint32_t seq = 0;
+    for (auto _ : state) {
+        pgw::GtpWriter writer(buffer, sizeof(buffer), pgw::GtpMessageType::CREATE_SESSION_RESPONSE,
+                              0x11223344u, ++seq);
+        writer.add_cause(pgw::GtpCause::REQUEST_ACCEPTED);
+        writer.add_fteid(0, pgw::kFteidS5S8PgwGtpC, seq, 0x0100007F);
+        benchmark::DoNotOptimize(writer.finish());
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_GtpBuildCreateSessionResponse);
@@ -0,0 +1,77 @@
+#include <benchmark/benchmark.h>
+#include <httplib.h>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <set>
+#include <string>
+#include <thread>
+#include "CDRLogger.hpp"
+#include "HttpApi.hpp"
+#include "SessionManager.hpp"
+
+namespace {
+
+constexpr uint16_t kBenchHttpPort = 18080;
+
+struct HttpBenchServer {
+    std::set<std::string> blacklist;
+    pgw::SessionManager sessions{3600, blacklist, 1000};
+    pgw::CDRLogger cdr{"/tmp/pgw_bench_http_cdr.log"};
+    std::atomic<bool> shutdown_requested{false};
+    std::unique_ptr<pgw::HttpApi> api;
+    
+    explicit HttpBenchServer(unsigned threads) {
+        sessions.try_create_session("001010123456780");
+        pgw::HttpOptions options;
+        options.threads = threads;
+        options.keep_alive_max_count = 1000000;
+        api = std::make_unique<pgw::HttpApi>(kBenchHttpPort, sessions, cdr, shutdown_requested, 0, options);
+        api->run();
+        
+        // ждем, пока сервер начнет принимать соединения
+        httplib::Client probe("127.0.0.1", kBenchHttpPort);
+        for (int i = 0; i < 100 && !probe.Get("/metrics"); ++i) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+    }
+    
+    ~HttpBenchServer() {
+        api->stop();
+        std::remove("/tmp/pgw_bench_http_cdr.log");
+    }
+};
+
+std::unique_ptr<HttpBenchServer> g_server;
+
+} // namespace
+
+// пропускная способность /check_subscriber: state.threads() клиентов
+// с keep-alive соединениями против пула из state.range(0) обработчиков
+static void BM_HttpCheckSubscriber(benchmark::State& state) {
+    if (state.thread_index() == 0) {
+        g_server = std::make_unique<HttpBenchServer>(state.range(0));
+    }
+    
+    // соединение открывается при первом запросе, уже после запуска сервера
+    httplib::Client client("127.0.0.1", kBenchHttpPort);
+    client.set_keep_alive(true);
+    for (auto _ : state) {
+        auto res = client.Get("/check_subscriber?imsi=001010123456780");
+        if (!res || res->status != 200) {
+            state.SkipWithError("нет ответа HTTP сервера");
+            break;
+        }
+        benchmark::DoNotOptimize(res->body.data());
+    }
+    state.SetItemsProcessed(state.iterations());
+    
+    if (state.thread_index() == 0) {
+        g_server.reset();
+    }
+}
+BENCHMARK(BM_HttpCheckSubscriber)
+    ->ArgName("pool")->Arg(1)->Arg(4)->Arg(8)
+    ->Threads(1)->Threads(4)->Threads(16)
+    ->UseRealTime();
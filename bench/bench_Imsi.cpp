@@ -0,0 +1,48 @@
+#include <benchmark/benchmark.h>
+#include <string>
+#include <vector>
+#include "Imsi.hpp"
+
+namespace {
+
+std::vector<std::string> make_imsis(size_t count) {
+    std::vector<std::string> imsis;
+    for (size_t i = 0; i < count; ++i) {
+        imsis.push_back(std::to_string(1010000000000000ull + i * 7919).substr(1));
+    }
+    return imsis;
+}
+
+} // namespace
+
+static void BM_ImsiParse(benchmark::State& state) {
+    const auto imsis = make_imsis(1024);
+    size_t i = 0;
+    for (auto _ : state) {
+        auto imsi = pgw::Imsi::parse(imsis[i++ & 1023]);
+        benchmark::DoNotOptimize(imsi);
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_ImsiParse);
+
+static void BM_ImsiToChars(benchmark::State& state) {
+    const pgw::Imsi imsi("001010123456780");
+    char buf[pgw::Imsi::kMaxDigits];
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(imsi.to_chars(buf));
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_ImsiToChars);
+
+static void BM_ImsiHash(benchmark::State& state) {
+    uint64_t raw = pgw::Imsi("001010123456780").raw();
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(std::hash<pgw::Imsi>{}(pgw::Imsi::from_raw(raw)));
+        raw += 0x10;
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_ImsiHash);
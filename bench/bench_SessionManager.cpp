@@ -0,0 +1,110 @@
+#include <benchmark/benchmark.h>
+#include <chrono>
+#include <memory>
+#include <set>
+#include <string>
+#include <thread>
+#include "SessionManager.hpp"
+
+namespace {
+
+// IMSI из 15 цифр с номером n, без аллокаций
+pgw::Imsi imsi_for(uint64_t n) {
+    char digits[pgw::Imsi::kMaxDigits];
+    for (size_t i = pgw::Imsi::kMaxDigits; i > 0; --i) {
+        digits[i - 1] = static_cast<char>('0' + n % 10);
+        n /= 10;
+    }
+    return *pgw::Imsi::parse(std::string_view(digits, sizeof(digits)));
+}
+
+const std::set<std::string> kBlacklist{"001010123456789", "001010000000001"};
+
+// общий для всех потоков менеджер с table_size уже созданными сессиями
+std::unique_ptr<pgw::SessionManager> prefilled(unsigned table_size, unsigned timeout_sec = 3600) {
+    auto manager = std::make_unique<pgw::SessionManager>(timeout_sec, kBlacklist, table_size * 2);
+    for (unsigned i = 0; i < table_size; ++i) {
+        manager->try_create_session(imsi_for(i));
+    }
+    return manager;
+}
+
+std::unique_ptr<pgw::SessionManager> g_manager;
+
+} // namespace
+
+// создание новой сессии и ее удаление: размер таблицы остается постоянным
+static void BM_SessionCreateRemove(benchmark::State& state) {
+    const unsigned table_size = state.range(0);
+    if (state.thread_index() == 0) g_manager = prefilled(table_size);
+    
+    // у каждого потока свой диапазон новых IMSI
+    uint64_t n = 1000000000ull * (state.thread_index() + 1);
+    for (auto _ : state) {
+        const auto imsi = imsi_for(n++);
+        benchmark::DoNotOptimize(g_manager->try_create_session(imsi));
+        g_manager->remove_session(imsi);
+    }
+    state.SetItemsProcessed(state.iterations());
+    
+    if (state.thread_index() == 0) g_manager.reset();
+}
+BENCHMARK(BM_SessionCreateRemove)->RangeMultiplier(100)->Range(100, 1000000)->ThreadRange(1, 8)->UseRealTime();
+
+// повторный запрос существующей сессии (ALREADY_EXISTS) - самый частый путь
+static void BM_SessionCreateExisting(benchmark::State& state) {
+    const unsigned table_size = state.range(0);
+    if (state.thread_index() == 0) g_manager = prefilled(table_size);
+    
+    uint64_t n = state.thread_index() * 7919;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(g_manager->try_create_session(imsi_for(n++ % table_size)));
+    }
+    state.SetItemsProcessed(state.iterations());
+    
+    if (state.thread_index() == 0) g_manager.reset();
+}
+BENCHMARK(BM_SessionCreateExisting)->RangeMultiplier(100)->Range(100, 1000000)->ThreadRange(1, 8)->UseRealTime();
+
+static void BM_SessionIsActive(benchmark::State& state) {
+    const unsigned table_size = state.range(0);
+    if (state.thread_index() == 0) g_manager = prefilled(table_size);
+    
+    // половина запросов - промахи
+    uint64_t n = state.thread_index() * 7919;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(g_manager->is_active(imsi_for(n++ % (table_size * 2))));
+    }
+    state.SetItemsProcessed(state.iterations());
+    
+    if (state.thread_index() == 0) g_manager.reset();
+}
+BENCHMARK(BM_SessionIsActive)->RangeMultiplier(100)->Range(100, 1000000)->ThreadRange(1, 8)->UseRealTime();
+
+// удаление всех сессий таблицы за один проход (таймаут 0 - все истекли)
+static void BM_RemoveExpiredAll(benchmark::State& state) {
+    const unsigned table_size = state.range(0);
+    for (auto _ : state) {
+        state.PauseTiming();
+        auto manager = prefilled(table_size, 0);
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        state.ResumeTiming();
+        
+        manager->remove_expired_sessions();
+        
+        state.PauseTiming();
+        manager.reset();
+        state.ResumeTiming();
+    }
+    state.SetItemsProcessed(state.iterations() * table_size);
+}
+BENCHMARK(BM_RemoveExpiredAll)->RangeMultiplier(100)->Range(100, 1000000)->Unit(benchmark::kMicrosecond);
+
+// тик истечения без истекших сессий: цена не должна зависеть от размера таблицы
+static void BM_RemoveExpiredNone(benchmark::State& state) {
+    auto manager = prefilled(state.range(0));
+    for (auto _ : state) {
+        manager->remove_expired_sessions();
+    }
+}
+BENCHMARK(BM_RemoveExpiredNone)->RangeMultiplier(100)->Range(100, 1000000);
@@ -0,0 +1,110 @@
+#include <benchmark/benchmark.h>
+#include <arpa/inet.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <cstdio>
+#include <memory>
+#include <set>
+#include <string>
+#include <thread>
+#include "CDRLogger.hpp"
+#include "SessionManager.hpp"
+#include "UdpServer.hpp"
+
+namespace {
+
+// state.range(1): 0 - epoll, 1 - io_uring
+pgw::UdpBackend backend_of(const benchmark::State& state) {
+    return state.range(1) ? pgw::UdpBackend::IO_URING : pgw::UdpBackend::EPOLL;
+}
+
+// встроенный сервер в своем потоке и подключенный к нему клиентский сокет
+struct LoopbackServer {
+    explicit LoopbackServer(const benchmark::State& state)
+        : sessions(3600, blacklist, 1000000),
+          cdr(cdr_file),
+          server("127.0.0.1", 0, sessions, cdr, state.range(0), false, nullptr, backend_of(state)),
+          server_thread([this] { server.run(); }) {
+        fd = socket(AF_INET, SOCK_DGRAM, 0);
+        timeval tv{1, 0};
+        setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+        sockaddr_in addr{};
+        addr.sin_family = AF_INET;
+        addr.sin_port = htons(server.port());
+        inet_pton(AF_INET, "127.0.0.1", &addr.sin_addr);
+        connect(fd, (sockaddr*)&addr, sizeof(addr));
+    }
+    
+    ~LoopbackServer() {
+        close(fd);
+        server.stop();
+        server_thread.join();
+        std::remove(cdr_file.c_str());
+    }
+    
+    const std::string cdr_file = "/tmp/pgw_bench_udp_cdr.log";
+    std::set<std::string> blacklist;
+    pgw::SessionManager sessions;
+    pgw::CDRLogger cdr;
+    pgw::UdpServer server;
+    std::thread server_thread;
+    int fd;
+};
+
+// в основном повторные запросы (ALREADY_EXISTS), как у реальных абонентов
+const std::string kImsis[] = {"001010123456780", "001010123456781", "001010123456782"};
+
+void backend_args(benchmark::internal::Benchmark* b) {
+    b->ArgNames({"batch", "uring"});
+    b->Args({1, 0})->Args({32, 0});
+#ifdef PGW_WITH_IO_URING
+    // размер пачки к io_uring не относится
+    b->Args({1, 1});
+#endif
+}
+
+} // namespace
+
+// полный цикл запрос-ответ через loopback со встроенным сервером: один
+// запрос в полете, state.range(0) - размер пачки сервера (1 - recvfrom,
+// >1 - recvmmsg), state.range(1) - io_uring вместо epoll
+static void BM_UdpRoundTrip(benchmark::State& state) {
+    LoopbackServer loopback(state);
+    
+    char reply[32];
+    size_t i = 0;
+    for (auto _ : state) {
+        const auto& imsi = kImsis[i++ % 3];
+        send(loopback.fd, imsi.data(), imsi.size(), 0);
+        if (recv(loopback.fd, reply, sizeof(reply), 0) <= 0) {
+            state.SkipWithError("нет ответа сервера");
+            break;
+        }
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_UdpRoundTrip)->Apply(backend_args)->UseRealTime();
+
+// пропускная способность: окно из 64 запросов в полете, здесь видна
+// разница между системным вызовом на датаграмму и пачками
+static void BM_UdpPipelined(benchmark::State& state) {
+    constexpr int kWindow = 64;
+    LoopbackServer loopback(state);
+    
+    char reply[32];
+    size_t i = 0;
+    for (auto _ : state) {
+        for (int k = 0; k < kWindow; ++k) {
+            const auto& imsi = kImsis[i++ % 3];
+            send(loopback.fd, imsi.data(), imsi.size(), 0);
+        }
+        for (int k = 0; k < kWindow; ++k) {
+            if (recv(loopback.fd, reply, sizeof(reply), 0) <= 0) {
+                state.SkipWithError("ответ потерян");
+                return;
+            }
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * kWindow);
+}
+BENCHMARK(BM_UdpPipelined)->Apply(backend_args)->UseRealTime();
@@ -0,0 +1,14 @@
+#include <benchmark/benchmark.h>
+#include <spdlog/spdlog.h>
+
+// свой main вместо benchmark_main: на горячем пути много spdlog::info,
+// в замерах он измерял бы вывод в консоль, а не сам код
+int main(int argc, char** argv) {
+    spdlog::set_level(spdlog::level::off);
+    
+    benchmark::Initialize(&argc, argv);
+    if (benchmark::ReportUnrecognizedArguments(argc, argv)) return 1;
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+    return 0;
+}
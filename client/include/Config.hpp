@@ -9,6 +9,11 @@ struct ClientConfig {
     uint16_t server_port;
     std::string log_file;
     std::string log_level;
+    unsigned request_timeout_ms;  // ожидание ответа на одну попытку
+    unsigned max_retries;         // повторных отправок после таймаута
+    unsigned pipeline_sockets;    // сокетов (запросов в полете) у PipelinedClient
+    std::string protocol;         // "text" - IMSI в ASCII, "binary" - пакеты с seq
+    unsigned imsis_per_packet;    // IMSI в одном бинарном пакете (1..255)
 };
 
 ClientConfig load_client_config(const std::string& file_path);
@@ -0,0 +1,94 @@
+#pragma once
+#include <chrono>
+#include <cstdint>
+#include <random>
+#include <string>
+#include <vector>
+#include "Config.hpp"
+
+namespace pgw {
+
+struct LoadOptions {
+    unsigned threads = 1;            // потоки генератора
+    unsigned sockets = 8;            // сокетов на поток (разные порты - разные воркеры сервера)
+    unsigned window = 64;            // запросов в полете на сокет
+    unsigned batch = 32;             // датаграмм на один sendmmsg
+    uint64_t rate = 0;               // запросов/сек на весь генератор, 0 - без ограничения
+    unsigned duration_sec = 10;      // длительность теста, 0 - до total_requests
+    uint64_t total_requests = 0;     // 0 - без ограничения
+    unsigned timeout_ms = 1000;      // ответ считается потерянным по истечении
+    
+    // распределение IMSI: номера 0..imsi_count-1 с префиксом imsi_prefix
+    std::string imsi_prefix = "00101";
+    uint64_t imsi_count = 1000000;
+    std::string distribution = "uniform";  // "uniform" или "hotset"
+    uint64_t hot_set = 1000;               // размер горячего множества
+    double hot_ratio = 0.9;                // доля запросов в горячее множество
+    double blacklist_ratio = 0.0;          // доля запросов с IMSI из черного списка
+    std::string blacklist_imsi = "001010123456789";
+};
+
+// гистограмма задержек с шагом 1 мкс до 100 мс, дальше - одна корзина
+class LatencyHistogram {
+public:
+    LatencyHistogram();
+    void record(std::chrono::nanoseconds latency);
+    void merge(const LatencyHistogram& other);
+    uint64_t count() const { return count_; }
+    // q в [0, 1]; результат в микросекундах
+    uint64_t percentile_us(double q) const;
+    uint64_t max_us() const { return max_us_; }
+
+private:
+    static constexpr size_t kBuckets = 100000;
+    std::vector<uint64_t> buckets_;  // последняя - переполнение
+    uint64_t count_ = 0;
+    uint64_t max_us_ = 0;
+};
+
+struct LoadReport {
+    uint64_t sent = 0;
+    uint64_t received = 0;
+    uint64_t created = 0;
+    uint64_t rejected = 0;
+    uint64_t lost = 0;       // не дождались ответа за timeout_ms
+    uint64_t send_errors = 0;
+    std::chrono::duration<double> elapsed{0};
+    LatencyHistogram latency;
+    
+    void merge(const LoadReport& other);
+};
+
+// генератор нагрузки: один процесс, много сокетов, пакетные sendmmsg/recvmmsg.
+// сервер отвечает без идентификатора запроса, поэтому ответы сопоставляются
+// с запросами по порядку внутри сокета: один клиентский сокет всегда
+// попадает в один воркер сервера, который отвечает в порядке приема
+class LoadGenerator {
+public:
+    LoadGenerator(const ClientConfig& config, const LoadOptions& options);
+    LoadReport run();
+
+private:
+    LoadReport run_thread(unsigned index);
+    
+    const ClientConfig& config_;
+    const LoadOptions options_;
+};
+
+// генератор IMSI с заданным распределением
+class ImsiGenerator {
+public:
+    ImsiGenerator(const LoadOptions& options, uint64_t seed);
+    // пишет IMSI в out (не меньше 15 байт), возвращает длину
+    size_t next(char* out);
+
+private:
+    size_t format(uint64_t number, char* out) const;
+    
+    const LoadOptions& options_;
+    std::mt19937_64 rng_;
+    std::uniform_real_distribution<double> coin_{0.0, 1.0};
+    size_t digits_;  // цифр после префикса
+};
+
+} // namespace pgw
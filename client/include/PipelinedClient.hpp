@@ -0,0 +1,109 @@
+#pragma once
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <string>
+#include <vector>
+#include <netinet/in.h>
+#include "Config.hpp"
+#include "Protocol.hpp"
+
+namespace pgw {
+
+struct RequestResult {
+    enum class Status {
+        OK,          // получен ответ сервера
+        TIMEOUT,     // нет ответа после всех повторов
+        SEND_ERROR,  // датаграмму не удалось отправить
+        INVALID_IMSI // бинарный протокол: IMSI не упаковать, запрос не отправлялся
+    };
+    
+    std::string imsi;
+    // текстовый протокол: "created" / "rejected", для delete и refresh -
+    // "deleted" / "refreshed" / "not_found";
+    // бинарный: to_string(ResultCode) - "created", "exists", "rejected_blacklist"...
+    // пусто при ошибке
+    std::string response;
+    Status status = Status::TIMEOUT;
+    unsigned attempts = 0;
+    std::chrono::microseconds latency{0};  // от отправки первой попытки до ответа
+};
+
+// асинхронный клиент: много запросов в полете, таймауты и повторная отправка.
+// у каждого пакета в полете свой сокет (connect() к серверу).
+// текстовый протокол: ответ без идентификатора сопоставляется по сокету,
+// после повторов сокет заменяется, чтобы запоздавший ответ не достался
+// следующему запросу. бинарный протокол: в пакете до imsis_per_packet IMSI,
+// ответ проверяется по seq, чужие и запоздавшие ответы отбрасываются.
+// класс не потокобезопасен: submit() и poll() вызываются из одного потока
+class PipelinedClient {
+public:
+    using Callback = std::function<void(const RequestResult&)>;
+    
+    // operation - тип запроса для всех IMSI: создание, удаление или продление
+    explicit PipelinedClient(const ClientConfig& config,
+                             PacketType operation = PacketType::CREATE_REQUEST);
+    ~PipelinedClient();
+    
+    PipelinedClient(const PipelinedClient&) = delete;
+    PipelinedClient& operator=(const PipelinedClient&) = delete;
+    
+    // ставим запрос в очередь; callback вызывается из poll() по завершении
+    void submit(std::string imsi, Callback callback);
+    
+    // отправляем ожидающие запросы, ждем ответов не дольше timeout_ms,
+    // обрабатываем таймауты; возвращаем число завершенных запросов
+    size_t poll(int timeout_ms);
+    
+    // запросов в очереди плюс пакетов в полете; 0 - все завершены
+    size_t pending() const { return queue_.size() + in_flight_; }
+    
+    // пакетный режим: отправляем все IMSI и ждем всех результатов,
+    // результаты в порядке входного списка
+    std::vector<RequestResult> send_batch(const std::vector<std::string>& imsis);
+
+private:
+    using Clock = std::chrono::steady_clock;
+    
+    struct Request {
+        std::string imsi;
+        Callback callback;
+    };
+    
+    struct Slot {
+        int fd = -1;
+        bool busy = false;
+        std::vector<Request> requests;  // в текстовом протоколе - один
+        std::string payload;            // датаграмма для (повторной) отправки
+        uint32_t seq = 0;
+        unsigned attempts = 0;
+        Clock::time_point first_sent_at;
+        Clock::time_point deadline;
+    };
+    
+    int open_socket() const;
+    void recycle_socket(Slot& slot);
+    bool transmit(Slot& slot);
+    void dispatch();
+    // проверяем, что ответ относится к пакету слота
+    bool matches(const Slot& slot, std::string_view reply) const;
+    // reply - ответ сервера, пустой при ошибке
+    void complete(Slot& slot, RequestResult::Status status, std::string_view reply);
+    
+    const ClientConfig& config_;
+    sockaddr_in server_addr_{};
+    const std::chrono::milliseconds timeout_;
+    const bool binary_;
+    const PacketType operation_;
+    const size_t imsis_per_packet_;
+    uint32_t next_seq_ = 1;
+    
+    std::vector<Slot> slots_;
+    std::vector<size_t> free_slots_;
+    std::deque<Request> queue_;
+    size_t in_flight_ = 0;
+    size_t completed_ = 0;  // счетчик для poll()
+};
+
+} // namespace pgw
@@ -1,6 +1,9 @@
 #pragma once
 #include <string>
+#include <string_view>
+#include <vector>
 #include <netinet/in.h>
+#include <sys/socket.h>
 #include <spdlog/spdlog.h>
 #include "Config.hpp"
 
@@ -9,13 +12,33 @@ namespace pgw {
 class UdpClient {
 public:
     UdpClient(const ClientConfig& config);
+    ~UdpClient();
+    
+    UdpClient(const UdpClient&) = delete;
+    UdpClient& operator=(const UdpClient&) = delete;
     
     std::string send_request(const std::string& imsi);
+    
+    // отправляем пачку датаграмм одним sendmmsg, возвращаем число отправленных
+    // (-1 - ошибка). payloads должны жить до возврата из вызова
+    int send_batch(const std::vector<std::string_view>& payloads);
+    // забираем без ожидания все уже пришедшие ответы (recvmmsg, не больше max_count),
+    // ответы дописываются в responses; возвращаем их число
+    int receive_batch(std::vector<std::string>& responses, unsigned max_count);
+    
+    int fd() const { return sockfd_; }  // для poll() в генераторе нагрузки
 
 private:
     int sockfd_;
     sockaddr_in server_addr_;
     const ClientConfig& config_;
+    
+    // буферы пакетных вызовов, переиспользуются между вызовами
+    std::vector<mmsghdr> tx_msgs_;
+    std::vector<iovec> tx_iov_;
+    std::vector<mmsghdr> rx_msgs_;
+    std::vector<iovec> rx_iov_;
+    std::vector<char> rx_buffers_;
 };
 
-} // namespace pgw
\ No newline at end of file
+} // namespace pgw
@@ -21,7 +21,12 @@ ClientConfig load_client_config(const std::string& file_path) {
         .server_ip = config["server_ip"].get<std::string>(),
         .server_port = config["server_port"].get<uint16_t>(),
         .log_file = config["log_file"].get<std::string>(),
-        .log_level = config["log_level"].get<std::string>()
+        .log_level = config["log_level"].get<std::string>(),
+        .request_timeout_ms = config.value("request_timeout_ms", 1000u),
+        .max_retries = config.value("max_retries", 2u),
+        .pipeline_sockets = config.value("pipeline_sockets", 64u),
+        .protocol = config.value("protocol", std::string("text")),
+        .imsis_per_packet = config.value("imsis_per_packet", 64u)
     };
 }
 
@@ -0,0 +1,238 @@
+#include "LoadGenerator.hpp"
+#include "UdpClient.hpp"
+#include <poll.h>
+#include <algorithm>
+#include <cstring>
+#include <future>
+#include <memory>
+#include <string_view>
+
+namespace pgw {
+
+using Clock = std::chrono::steady_clock;
+
+namespace {
+constexpr size_t kImsiDigits = 15;
+}
+
+LatencyHistogram::LatencyHistogram() : buckets_(kBuckets + 1, 0) {}
+
+void LatencyHistogram::record(std::chrono::nanoseconds latency) {
+    const uint64_t us = std::max<int64_t>(latency.count(), 0) / 1000;
+    buckets_[std::min<uint64_t>(us, kBuckets)]++;
+    max_us_ = std::max(max_us_, us);
+    count_++;
+}
+
+void LatencyHistogram::merge(const LatencyHistogram& other) {
+    for (size_t i = 0; i <= kBuckets; ++i) {
+        buckets_[i] += other.buckets_[i];
+    }
+    count_ += other.count_;
+    max_us_ = std::max(max_us_, other.max_us_);
+}
+
+uint64_t LatencyHistogram::percentile_us(double q) const {
+    if (count_ == 0) return 0;
+    // ранг наблюдения, которое должно оказаться не ниже q
+    const uint64_t rank = std::max<uint64_t>(1, static_cast<uint64_t>(q * count_ + 0.5));
+    uint64_t seen = 0;
+    for (size_t i = 0; i < kBuckets; ++i) {
+        seen += buckets_[i];
+        if (seen >= rank) return i;
+    }
+    return max_us_;  // в корзине переполнения
+}
+
+void LoadReport::merge(const LoadReport& other) {
+    sent += other.sent;
+    received += other.received;
+    created += other.created;
+    rejected += other.rejected;
+    lost += other.lost;
+    send_errors += other.send_errors;
+    elapsed = std::max(elapsed, other.elapsed);
+    latency.merge(other.latency);
+}
+
+ImsiGenerator::ImsiGenerator(const LoadOptions& options, uint64_t seed)
+    : options_(options),
+      rng_(seed),
+      digits_(kImsiDigits - std::min(options.imsi_prefix.size(), kImsiDigits)) {}
+
+size_t ImsiGenerator::format(uint64_t number, char* out) const {
+    std::memcpy(out, options_.imsi_prefix.data(), kImsiDigits - digits_);
+    for (size_t i = kImsiDigits; i > kImsiDigits - digits_; --i) {
+        out[i - 1] = static_cast<char>('0' + number % 10);
+        number /= 10;
+    }
+    return kImsiDigits;
+}
+
+size_t ImsiGenerator::next(char* out) {
+    if (options_.blacklist_ratio > 0 && coin_(rng_) < options_.blacklist_ratio) {
+        const auto& imsi = options_.blacklist_imsi;
+        std::memcpy(out, imsi.data(), std::min(imsi.size(), kImsiDigits));
+        return std::min(imsi.size(), kImsiDigits);
+    }
+    
+    uint64_t range = std::max<uint64_t>(options_.imsi_count, 1);
+    if (options_.distribution == "hotset" && coin_(rng_) < options_.hot_ratio) {
+        range = std::clamp<uint64_t>(options_.hot_set, 1, range);
+    }
+    return format(rng_() % range, out);
+}
+
+LoadGenerator::LoadGenerator(const ClientConfig& config, const LoadOptions& options)
+    : config_(config), options_(options) {}
+
+LoadReport LoadGenerator::run() {
+    std::vector<std::future<LoadReport>> workers;
+    for (unsigned i = 0; i < std::max(options_.threads, 1u); ++i) {
+        workers.push_back(std::async(std::launch::async, &LoadGenerator::run_thread, this, i));
+    }
+    
+    LoadReport report;
+    for (auto& worker : workers) {
+        report.merge(worker.get());
+    }
+    return report;
+}
+
+LoadReport LoadGenerator::run_thread(unsigned index) {
+    // запросы одного сокета в порядке отправки: кольцо времен отправки
+    struct Flow {
+        std::unique_ptr<UdpClient> client;
+        std::vector<Clock::time_point> sent_at;
+        size_t head = 0;
+        size_t inflight = 0;
+    };
+    
+    const unsigned threads = std::max(options_.threads, 1u);
+    const unsigned window = std::max(options_.window, 1u);
+    const unsigned batch = std::max(options_.batch, 1u);
+    const auto response_timeout = std::chrono::milliseconds(options_.timeout_ms);
+    
+    // доля потока в общем лимите запросов и скорости
+    uint64_t quota = options_.total_requests / threads;
+    if (index < options_.total_requests % threads) quota++;
+    const double rate = double(options_.rate) / threads;
+    
+    std::vector<Flow> flows(std::max(options_.sockets, 1u));
+    for (auto& flow : flows) {
+        flow.client = std::make_unique<UdpClient>(config_);
+        flow.sent_at.resize(window);
+    }
+    
+    ImsiGenerator imsis(options_, std::random_device{}() ^ (uint64_t(index) << 32));
+    std::vector<char> payload_storage(batch * kImsiDigits);
+    std::vector<std::string_view> payloads;
+    std::vector<std::string> responses;
+    std::vector<pollfd> fds(flows.size());
+    
+    LoadReport report;
+    const auto start = Clock::now();
+    const auto deadline = start + std::chrono::seconds(options_.duration_sec);
+    Clock::time_point stopped_at{};
+    
+    for (;;) {
+        auto now = Clock::now();
+        const bool sending = (options_.duration_sec == 0 || now < deadline) &&
+                             (options_.total_requests == 0 || report.sent < quota);
+        size_t inflight = 0;
+        for (const auto& flow : flows) inflight += flow.inflight;
+        
+        if (!sending) {
+            if (stopped_at == Clock::time_point{}) stopped_at = now;
+            // дожидаемся ответов на отправленное, но не дольше таймаута
+            if (inflight == 0 || now - stopped_at > response_timeout) {
+                for (const auto& flow : flows) report.lost += flow.inflight;
+                break;
+            }
+        }
+        
+        // сколько можно отправить сейчас, не превышая заданной скорости
+        uint64_t allowed = 0;
+        if (sending) {
+            allowed = UINT64_MAX;
+            if (rate > 0) {
+                const double elapsed = std::chrono::duration<double>(now - start).count();
+                const uint64_t target = static_cast<uint64_t>(elapsed * rate) + 1;
+                allowed = target > report.sent ? target - report.sent : 0;
+            }
+            if (options_.total_requests > 0) {
+                allowed = std::min(allowed, quota - report.sent);
+            }
+        }
+        
+        bool can_send_more = false;
+        for (auto& flow : flows) {
+            if (allowed == 0) break;
+            const size_t count = std::min<uint64_t>({window - flow.inflight, batch, allowed});
+            if (count == 0) continue;
+            
+            payloads.clear();
+            for (size_t i = 0; i < count; ++i) {
+                char* out = payload_storage.data() + i * kImsiDigits;
+                payloads.emplace_back(out, imsis.next(out));
+            }
+            const int sent = flow.client->send_batch(payloads);
+            const size_t accepted = sent > 0 ? sent : 0;
+            report.send_errors += count - accepted;
+            
+            const auto sent_at = Clock::now();
+            for (size_t i = 0; i < accepted; ++i) {
+                flow.sent_at[(flow.head + flow.inflight) % window] = sent_at;
+                flow.inflight++;
+            }
+            report.sent += accepted;
+            allowed -= count;
+            can_send_more |= flow.inflight < window;
+        }
+        
+        // ждем ответов; не блокируемся, если есть что отправлять без ограничения скорости
+        for (size_t i = 0; i < flows.size(); ++i) {
+            fds[i] = pollfd{flows[i].client->fd(), POLLIN, 0};
+        }
+        const int wait_ms = (sending && can_send_more && allowed > 0) ? 0 : 1;
+        if (poll(fds.data(), fds.size(), wait_ms) < 0 && errno != EINTR) {
+            break;
+        }
+        
+        now = Clock::now();
+        for (size_t i = 0; i < flows.size(); ++i) {
+            auto& flow = flows[i];
+            if (fds[i].revents & POLLIN) {
+                responses.clear();
+                flow.client->receive_batch(responses, window);
+                for (const auto& response : responses) {
+                    if (flow.inflight == 0) break;  // лишний ответ, сопоставлять не с чем
+                    report.latency.record(now - flow.sent_at[flow.head]);
+                    flow.head = (flow.head + 1) % window;
+                    flow.inflight--;
+                    report.received++;
+                    if (response == "created") {
+                        report.created++;
+                    } else {
+                        report.rejected++;
+                    }
+                }
+            }
+            
+            // самый старый запрос сокета просрочен: считаем потерянными все его
+            // запросы и меняем сокет, чтобы поздние ответы не сбили порядок
+            if (flow.inflight > 0 && now - flow.sent_at[flow.head] > response_timeout) {
+                report.lost += flow.inflight;
+                flow.inflight = 0;
+                flow.head = 0;
+                flow.client = std::make_unique<UdpClient>(config_);
+            }
+        }
+    }
+    
+    // пропускную способность считаем по времени отправки, без ожидания хвоста
+    report.elapsed = (stopped_at != Clock::time_point{} ? stopped_at : Clock::now()) - start;
+    return report;
+}
+
+} // namespace pgw
@@ -0,0 +1,240 @@
+#include "PipelinedClient.hpp"
+#include <arpa/inet.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include <spdlog/spdlog.h>
+
+namespace pgw {
+
+PipelinedClient::PipelinedClient(const ClientConfig& config, PacketType operation)
+    : config_(config),
+      timeout_(std::max(config.request_timeout_ms, 1u)),
+      binary_(config.protocol == "binary"),
+      operation_(operation),
+      imsis_per_packet_(binary_ ? std::clamp<size_t>(config.imsis_per_packet, 1, kMaxImsisPerPacket) : 1) {
+    
+    server_addr_.sin_family = AF_INET;
+    server_addr_.sin_port = htons(config.server_port);
+    if (inet_pton(AF_INET, config.server_ip.c_str(), &server_addr_.sin_addr) <= 0) {
+        throw std::runtime_error("Неверный IP сервера: " + config.server_ip);
+    }
+    
+    slots_.resize(std::max(config.pipeline_sockets, 1u));
+    for (size_t i = 0; i < slots_.size(); ++i) {
+        slots_[i].fd = open_socket();
+        free_slots_.push_back(slots_.size() - 1 - i);
+    }
+    
+    spdlog::info("Асинхронный клиент: сервер {}:{}, {} сокетов, таймаут {} мс, повторов {}, протокол {}",
+                 config.server_ip, config.server_port, slots_.size(),
+                 config.request_timeout_ms, config.max_retries, binary_ ? "binary" : "text");
+}
+
+PipelinedClient::~PipelinedClient() {
+    for (auto& slot : slots_) {
+        if (slot.fd >= 0) close(slot.fd);
+    }
+}
+
+int PipelinedClient::open_socket() const {
+    int fd = socket(AF_INET, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (fd < 0) {
+        throw std::runtime_error("Ошибка создания сокета: " + std::string(strerror(errno)));
+    }
+    // connect: ядро отбрасывает датаграммы не от сервера
+    if (connect(fd, (struct sockaddr*)&server_addr_, sizeof(server_addr_)) < 0) {
+        close(fd);
+        throw std::runtime_error("Ошибка connect: " + std::string(strerror(errno)));
+    }
+    return fd;
+}
+
+void PipelinedClient::recycle_socket(Slot& slot) {
+    close(slot.fd);
+    slot.fd = open_socket();
+}
+
+void PipelinedClient::submit(std::string imsi, Callback callback) {
+    queue_.push_back(Request{std::move(imsi), std::move(callback)});
+}
+
+bool PipelinedClient::transmit(Slot& slot) {
+    if (send(slot.fd, slot.payload.data(), slot.payload.size(), 0) < 0 && errno != ECONNREFUSED) {
+        spdlog::error("Ошибка отправки IMSI {}: {}", slot.requests.front().imsi, strerror(errno));
+        return false;
+    }
+    slot.attempts++;
+    slot.deadline = Clock::now() + timeout_;
+    return true;
+}
+
+void PipelinedClient::dispatch() {
+    while (!queue_.empty() && !free_slots_.empty()) {
+        Slot& slot = slots_[free_slots_.back()];
+        free_slots_.pop_back();
+        slot.busy = true;
+        slot.requests.clear();
+        slot.attempts = 0;
+        
+        if (!binary_) {
+            slot.requests.push_back(std::move(queue_.front()));
+            queue_.pop_front();
+            slot.payload = std::string(text_command(operation_)) + slot.requests.front().imsi;
+        } else {
+            // собираем в пакет до imsis_per_packet корректных IMSI;
+            // некорректные завершаем сразу, на сервер их не отправить
+            std::vector<Imsi> imsis;
+            while (!queue_.empty() && imsis.size() < imsis_per_packet_) {
+                Request request = std::move(queue_.front());
+                queue_.pop_front();
+                auto imsi = Imsi::parse(request.imsi);
+                if (!imsi) {
+                    RequestResult result;
+                    result.imsi = std::move(request.imsi);
+                    result.status = RequestResult::Status::INVALID_IMSI;
+                    completed_++;
+                    if (request.callback) request.callback(result);
+                    continue;
+                }
+                imsis.push_back(*imsi);
+                slot.requests.push_back(std::move(request));
+            }
+            if (imsis.empty()) {
+                slot.busy = false;
+                free_slots_.push_back(&slot - slots_.data());
+                continue;
+            }
+            slot.seq = next_seq_++;
+            slot.payload = encode_request(slot.seq, imsis, operation_);
+        }
+        
+        slot.first_sent_at = Clock::now();
+        in_flight_++;
+        if (!transmit(slot)) {
+            complete(slot, RequestResult::Status::SEND_ERROR, {});
+        }
+    }
+}
+
+bool PipelinedClient::matches(const Slot& slot, std::string_view reply) const {
+    if (!binary_) return true;
+    auto header = decode_header(reply);
+    return header && header->type == response_type(operation_) &&
+           header->seq == slot.seq && header->count == slot.requests.size();
+}
+
+void PipelinedClient::complete(Slot& slot, RequestResult::Status status, std::string_view reply) {
+    const auto latency = std::chrono::duration_cast<std::chrono::microseconds>(
+        Clock::now() - slot.first_sent_at);
+    std::vector<RequestResult> results(slot.requests.size());
+    for (size_t i = 0; i < slot.requests.size(); ++i) {
+        auto& result = results[i];
+        result.imsi = std::move(slot.requests[i].imsi);
+        result.status = status;
+        result.attempts = slot.attempts;
+        result.latency = latency;
+        if (status != RequestResult::Status::OK) continue;
+        if (binary_) {
+            result.response = to_string(static_cast<ResultCode>(reply[kPacketHeaderSize + i]));
+        } else {
+            result.response = reply;
+        }
+    }
+    
+    // после повторов на сокет может прийти еще один ответ - берем новый сокет.
+    // в бинарном протоколе такой ответ отбросится по seq
+    if (!binary_ && (slot.attempts > 1 || status != RequestResult::Status::OK)) {
+        recycle_socket(slot);
+    }
+    
+    std::vector<Request> requests = std::move(slot.requests);
+    slot.requests.clear();
+    slot.busy = false;
+    free_slots_.push_back(&slot - slots_.data());
+    in_flight_--;
+    completed_ += requests.size();
+    
+    for (size_t i = 0; i < requests.size(); ++i) {
+        if (requests[i].callback) requests[i].callback(results[i]);
+    }
+}
+
+size_t PipelinedClient::poll(int timeout_ms) {
+    completed_ = 0;
+    dispatch();
+    if (in_flight_ == 0) return completed_;
+    
+    // ждем не дольше ближайшего дедлайна
+    auto now = Clock::now();
+    auto nearest = now + std::chrono::milliseconds(std::max(timeout_ms, 0));
+    std::vector<pollfd> fds;
+    std::vector<size_t> index;
+    fds.reserve(in_flight_);
+    index.reserve(in_flight_);
+    for (size_t i = 0; i < slots_.size(); ++i) {
+        if (!slots_[i].busy) continue;
+        fds.push_back(pollfd{slots_[i].fd, POLLIN, 0});
+        index.push_back(i);
+        nearest = std::min(nearest, slots_[i].deadline);
+    }
+    const auto wait = std::chrono::ceil<std::chrono::milliseconds>(nearest - now);
+    if (::poll(fds.data(), fds.size(), std::max<int>(wait.count(), 0)) < 0 && errno != EINTR) {
+        spdlog::error("Ошибка poll: {}", strerror(errno));
+        return completed_;
+    }
+    
+    now = Clock::now();
+    for (size_t k = 0; k < fds.size(); ++k) {
+        Slot& slot = slots_[index[k]];
+        if (fds[k].revents & (POLLIN | POLLERR)) {
+            char buffer[kMaxResponseSize + 1];
+            ssize_t received = recv(slot.fd, buffer, sizeof(buffer), 0);
+            if (received >= 0 && matches(slot, std::string_view(buffer, received))) {
+                complete(slot, RequestResult::Status::OK, std::string_view(buffer, received));
+                continue;
+            }
+            if (received >= 0) {
+                spdlog::debug("Отброшен чужой или запоздавший ответ ({} байт)", received);
+            } else {
+                // ECONNREFUSED - ICMP "порт недоступен": ждем таймаута и повторяем
+                spdlog::debug("Ошибка получения для IMSI {}: {}",
+                              slot.requests.front().imsi, strerror(errno));
+            }
+        }
+        
+        if (now >= slot.deadline) {
+            if (slot.attempts <= config_.max_retries) {
+                spdlog::debug("Повторная отправка IMSI {} (попытка {})", slot.requests.front().imsi, slot.attempts + 1);
+                if (!transmit(slot)) {
+                    complete(slot, RequestResult::Status::SEND_ERROR, {});
+                }
+            } else {
+                spdlog::warn("Нет ответа на IMSI {} после {} попыток", slot.requests.front().imsi, slot.attempts);
+                complete(slot, RequestResult::Status::TIMEOUT, {});
+            }
+        }
+    }
+    
+    // освободившиеся сокеты сразу занимаем следующими запросами
+    dispatch();
+    return completed_;
+}
+
+std::vector<RequestResult> PipelinedClient::send_batch(const std::vector<std::string>& imsis) {
+    std::vector<RequestResult> results(imsis.size());
+    for (size_t i = 0; i < imsis.size(); ++i) {
+        submit(imsis[i], [&results, i](const RequestResult& result) {
+            results[i] = result;
+        });
+    }
+    while (pending() > 0) {
+        poll(static_cast<int>(timeout_.count()));
+    }
+    return results;
+}
+
+} // namespace pgw
@@ -22,38 +22,119 @@ UdpClient::UdpClient(const ClientConfig& config)
         throw std::runtime_error("Неверный IP сервера: " + config.server_ip);
     }
     
+    // таймаут ожидания ответа, чтобы потерянная датаграмма не вешала клиента
+    timeval tv{};
+    tv.tv_sec = config.request_timeout_ms / 1000;
+    tv.tv_usec = (config.request_timeout_ms % 1000) * 1000;
+    if (config.request_timeout_ms > 0) {
+        setsockopt(sockfd_, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+    }
+    
     spdlog::info("Клиент подключен к серверу {}:{}", 
                  config.server_ip, config.server_port);
 }
 
+UdpClient::~UdpClient() {
+    close(sockfd_);
+}
+
 std::string UdpClient::send_request(const std::string& imsi) {
-    // отправка IMSI
-    ssize_t sent = sendto(sockfd_, imsi.c_str(), imsi.size(), 0,
-                         (struct sockaddr*)&server_addr_, sizeof(server_addr_));
-    
-    if (sent < 0) {
-        spdlog::error("Ошибка отправки: {}", strerror(errno));
-        return "";
+    // после таймаута запрос отправляется повторно, до max_retries раз
+    for (unsigned attempt = 0; attempt <= config_.max_retries; ++attempt) {
+        // отправка IMSI
+        ssize_t sent = sendto(sockfd_, imsi.c_str(), imsi.size(), 0,
+                             (struct sockaddr*)&server_addr_, sizeof(server_addr_));
+        
+        if (sent < 0) {
+            spdlog::error("Ошибка отправки: {}", strerror(errno));
+            return "";
+        }
+        
+        spdlog::info("Отправлено {} байт: IMSI={}", sent, imsi);
+        
+        // получение ответа
+        char buffer[128] = {0};
+        sockaddr_in from_addr;
+        socklen_t len = sizeof(from_addr);
+        
+        ssize_t received = recvfrom(sockfd_, buffer, sizeof(buffer), 0,
+                                  (struct sockaddr*)&from_addr, &len);
+        
+        if (received < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            spdlog::warn("Нет ответа за {} мс (попытка {}/{}): IMSI={}",
+                         config_.request_timeout_ms, attempt + 1, config_.max_retries + 1, imsi);
+            continue;
+        }
+        if (received < 0) {
+            spdlog::error("Ошибка получения: {}", strerror(errno));
+            return "";
+        }
+        
+        std::string response(buffer, received);
+        spdlog::info("Получено {} байт: {}", received, response);
+        return response;
     }
     
-    spdlog::info("Отправлено {} байт: IMSI={}", sent, imsi);
-    
-    // получение ответа
-    char buffer[128] = {0};
-    sockaddr_in from_addr;
-    socklen_t len = sizeof(from_addr);
+    spdlog::error("Сервер не ответил: IMSI={}", imsi);
+    return "";
+}
+
+int UdpClient::send_batch(const std::vector<std::string_view>& payloads) {
+    const size_t n = payloads.size();
+    if (tx_msgs_.size() < n) {
+        tx_msgs_.resize(n);
+        tx_iov_.resize(n);
+    }
+    for (size_t i = 0; i < n; ++i) {
+        tx_iov_[i].iov_base = const_cast<char*>(payloads[i].data());
+        tx_iov_[i].iov_len = payloads[i].size();
+        tx_msgs_[i].msg_hdr = msghdr{};
+        tx_msgs_[i].msg_hdr.msg_iov = &tx_iov_[i];
+        tx_msgs_[i].msg_hdr.msg_iovlen = 1;
+        tx_msgs_[i].msg_hdr.msg_name = &server_addr_;
+        tx_msgs_[i].msg_hdr.msg_namelen = sizeof(server_addr_);
+    }
     
-    ssize_t received = recvfrom(sockfd_, buffer, sizeof(buffer), 0,
-                              (struct sockaddr*)&from_addr, &len);
+    // sendmmsg может отправить только начало пачки - досылаем хвост
+    size_t sent = 0;
+    while (sent < n) {
+        int r = sendmmsg(sockfd_, tx_msgs_.data() + sent, n - sent, 0);
+        if (r < 0) {
+            if (errno == EINTR) continue;
+            spdlog::error("Ошибка пакетной отправки: {}", strerror(errno));
+            return sent > 0 ? static_cast<int>(sent) : -1;
+        }
+        sent += r;
+    }
+    return static_cast<int>(sent);
+}
+
+int UdpClient::receive_batch(std::vector<std::string>& responses, unsigned max_count) {
+    constexpr size_t kResponseSize = 128;
+    if (rx_msgs_.size() < max_count) {
+        rx_msgs_.resize(max_count);
+        rx_iov_.resize(max_count);
+        rx_buffers_.resize(max_count * kResponseSize);
+        for (unsigned i = 0; i < max_count; ++i) {
+            rx_iov_[i].iov_base = rx_buffers_.data() + i * kResponseSize;
+            rx_iov_[i].iov_len = kResponseSize;
+            rx_msgs_[i].msg_hdr = msghdr{};
+            rx_msgs_[i].msg_hdr.msg_iov = &rx_iov_[i];
+            rx_msgs_[i].msg_hdr.msg_iovlen = 1;
+        }
+    }
     
+    int received = recvmmsg(sockfd_, rx_msgs_.data(), max_count, MSG_DONTWAIT, nullptr);
     if (received < 0) {
-        spdlog::error("Ошибка получения: {}", strerror(errno));
-        return "";
+        if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) {
+            spdlog::error("Ошибка пакетного приема: {}", strerror(errno));
+        }
+        return 0;
     }
-    
-    std::string response(buffer, received);
-    spdlog::info("Получено {} байт: {}", received, response);
-    return response;
+    for (int i = 0; i < received; ++i) {
+        responses.emplace_back(static_cast<const char*>(rx_iov_[i].iov_base), rx_msgs_[i].msg_len);
+    }
+    return received;
 }
 
-} // namespace pgw
\ No newline at end of file
+} // namespace pgw
@@ -0,0 +1,139 @@
+#include <getopt.h>
+#include <cstdio>
+#include <iostream>
+#include <string>
+#include <spdlog/spdlog.h>
+#include "Config.hpp"
+#include "LoadGenerator.hpp"
+
+namespace {
+
+void usage(const char* program) {
+    std::cerr <<
+        "Использование: " << program << " <конфиг клиента> [параметры]\n"
+        "  --threads N           потоков генератора (1)\n"
+        "  --sockets N           сокетов на поток (8)\n"
+        "  --window N            запросов в полете на сокет (64)\n"
+        "  --batch N             датаграмм на sendmmsg (32)\n"
+        "  --rate N              запросов/сек, 0 - максимум (0)\n"
+        "  --duration SEC        длительность теста, 0 - до --requests (10)\n"
+        "  --requests N          всего запросов, 0 - без ограничения (0)\n"
+        "  --timeout-ms N        таймаут ответа (1000)\n"
+        "  --prefix DIGITS       префикс IMSI (00101)\n"
+        "  --imsi-count N        число различных IMSI (1000000)\n"
+        "  --distribution NAME   uniform | hotset (uniform)\n"
+        "  --hot-set N           размер горячего множества (1000)\n"
+        "  --hot-ratio P         доля запросов в горячее множество (0.9)\n"
+        "  --blacklist-ratio P   доля запросов из черного списка (0)\n"
+        "  --blacklist-imsi IMSI IMSI из черного списка (001010123456789)\n";
+}
+
+} // namespace
+
+// генератор нагрузки: pgw_loadgen <конфиг> [параметры]
+int main(int argc, char* argv[]) {
+    if (argc < 2 || argv[1][0] == '-') {
+        usage(argv[0]);
+        return 1;
+    }
+    
+    static const option long_options[] = {
+        {"threads", required_argument, nullptr, 't'},
+        {"sockets", required_argument, nullptr, 's'},
+        {"window", required_argument, nullptr, 'w'},
+        {"batch", required_argument, nullptr, 'b'},
+        {"rate", required_argument, nullptr, 'r'},
+        {"duration", required_argument, nullptr, 'd'},
+        {"requests", required_argument, nullptr, 'n'},
+        {"timeout-ms", required_argument, nullptr, 'T'},
+        {"prefix", required_argument, nullptr, 'p'},
+        {"imsi-count", required_argument, nullptr, 'c'},
+        {"distribution", required_argument, nullptr, 'D'},
+        {"hot-set", required_argument, nullptr, 'H'},
+        {"hot-ratio", required_argument, nullptr, 'R'},
+        {"blacklist-ratio", required_argument, nullptr, 'B'},
+        {"blacklist-imsi", required_argument, nullptr, 'I'},
+        {nullptr, 0, nullptr, 0}
+    };
+    
+    pgw::LoadOptions options;
+    try {
+        optind = 2;
+        int opt;
+        while ((opt = getopt_long(argc, argv, "", long_options, nullptr)) != -1) {
+            switch (opt) {
+                case 't': options.threads = std::stoul(optarg); break;
+                case 's': options.sockets = std::stoul(optarg); break;
+                case 'w': options.window = std::stoul(optarg); break;
+                case 'b': options.batch = std::stoul(optarg); break;
+                case 'r': options.rate = std::stoull(optarg); break;
+                case 'd': options.duration_sec = std::stoul(optarg); break;
+                case 'n': options.total_requests = std::stoull(optarg); break;
+                case 'T': options.timeout_ms = std::stoul(optarg); break;
+                case 'p': options.imsi_prefix = optarg; break;
+                case 'c': options.imsi_count = std::stoull(optarg); break;
+                case 'D': options.distribution = optarg; break;
+                case 'H': options.hot_set = std::stoull(optarg); break;
+                case 'R': options.hot_ratio = std::stod(optarg); break;
+                case 'B': options.blacklist_ratio = std::stod(optarg); break;
+                case 'I': options.blacklist_imsi = optarg; break;
+                default:
+                    usage(argv[0]);
+                    return 1;
+            }
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "Неверное значение параметра: " << e.what() << "\n";
+        return 1;
+    }
+    
+    if (options.imsi_prefix.size() >= 15 ||
+        options.imsi_prefix.find_first_not_of("0123456789") != std::string::npos) {
+        std::cerr << "Префикс IMSI должен содержать от 0 до 14 цифр\n";
+        return 1;
+    }
+    if (options.distribution != "uniform" && options.distribution != "hotset") {
+        std::cerr << "Неизвестное распределение: " << options.distribution << "\n";
+        return 1;
+    }
+    if (options.duration_sec == 0 && options.total_requests == 0) {
+        std::cerr << "Нужно задать --duration или --requests\n";
+        return 1;
+    }
+    
+    try {
+        // из конфига берем только адрес сервера; логгер клиента не поднимаем,
+        // чтобы запись в файл не влияла на измерения
+        auto config = pgw::load_client_config(argv[1]);
+        spdlog::set_level(spdlog::level::warn);
+        
+        std::cout << "Нагрузка на " << config.server_ip << ":" << config.server_port
+                  << ": " << options.threads << " x " << options.sockets << " сокетов, окно "
+                  << options.window << ", скорость "
+                  << (options.rate ? std::to_string(options.rate) + "/сек" : std::string("максимальная"))
+                  << "\n";
+        
+        pgw::LoadGenerator generator(config, options);
+        const auto report = generator.run();
+        
+        const double seconds = report.elapsed.count();
+        std::printf("Отправлено:      %llu\n", (unsigned long long)report.sent);
+        std::printf("Получено:        %llu (created %llu, rejected %llu)\n",
+                    (unsigned long long)report.received,
+                    (unsigned long long)report.created,
+                    (unsigned long long)report.rejected);
+        std::printf("Потеряно:        %llu, ошибок отправки: %llu\n",
+                    (unsigned long long)report.lost, (unsigned long long)report.send_errors);
+        std::printf("Время:           %.2f сек\n", seconds);
+        std::printf("Пропускная:      %.0f ответов/сек\n", seconds > 0 ? report.received / seconds : 0.0);
+        std::printf("Задержка, мкс:   p50 %llu, p99 %llu, p99.9 %llu, max %llu\n",
+                    (unsigned long long)report.latency.percentile_us(0.50),
+                    (unsigned long long)report.latency.percentile_us(0.99),
+                    (unsigned long long)report.latency.percentile_us(0.999),
+                    (unsigned long long)report.latency.max_us());
+        return report.lost > 0 ? 2 : 0;
+    } catch (const std::exception& e) {
+        std::cerr << "Ошибка: " << e.what() << "\n";
+        return 1;
+    }
+}
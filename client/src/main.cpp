@@ -1,12 +1,31 @@
 #include <iostream>
+#include <string>
+#include <string_view>
+#include <vector>
 #include "Config.hpp"
 #include "UdpClient.hpp"
+#include "PipelinedClient.hpp"
 #include "Logger.hpp"
 #include <spdlog/spdlog.h>
 
 int main(int argc, char* argv[]) {
     if (argc < 3) {
-        std::cerr << "Использование: " << argv[0] << " <конфиг> <IMSI>\n";
+        std::cerr << "Использование: " << argv[0] << " <конфиг> [delete|refresh] <IMSI> [IMSI ...]\n";
+        return 1;
+    }
+    
+    // необязательная команда перед списком IMSI
+    int first_imsi = 2;
+    pgw::PacketType operation = pgw::PacketType::CREATE_REQUEST;
+    if (std::string_view(argv[2]) == "delete") {
+        operation = pgw::PacketType::DELETE_REQUEST;
+        first_imsi = 3;
+    } else if (std::string_view(argv[2]) == "refresh") {
+        operation = pgw::PacketType::REFRESH_REQUEST;
+        first_imsi = 3;
+    }
+    if (first_imsi >= argc) {
+        std::cerr << "Не указан IMSI\n";
         return 1;
     }
     
@@ -16,11 +35,37 @@ int main(int argc, char* argv[]) {
         
         // инициализация логгера КЛИЕНТА
         pgw::Logger::init_client(config.log_file, config.log_level);
-        spdlog::info("Запуск клиента с IMSI={}", argv[2]);
         
-        // создание и отправка запроса
+        // несколько IMSI - отправляем пакетом через асинхронный клиент
+        if (argc > first_imsi + 1) {
+            std::vector<std::string> imsis(argv + first_imsi, argv + argc);
+            spdlog::info("Запуск клиента с {} IMSI", imsis.size());
+            
+            pgw::PipelinedClient client(config, operation);
+            auto results = client.send_batch(imsis);
+            
+            int failed = 0;
+            for (const auto& result : results) {
+                if (result.status == pgw::RequestResult::Status::OK) {
+                    std::cout << result.imsi << ": " << result.response << "\n";
+                } else if (result.status == pgw::RequestResult::Status::INVALID_IMSI) {
+                    std::cout << result.imsi << ": неверный IMSI\n";
+                    failed++;
+                } else {
+                    std::cout << result.imsi << ": нет ответа\n";
+                    failed++;
+                }
+            }
+            spdlog::shutdown();
+            return failed > 0 ? 1 : 0;
+        }
+        
+        spdlog::info("Запуск клиента с IMSI={}", argv[first_imsi]);
+        
+        // создание и отправка запроса; команда идет текстом перед IMSI
         pgw::UdpClient client(config);
-        std::string response = client.send_request(argv[2]);
+        std::string response = client.send_request(
+            std::string(pgw::text_command(operation)) + argv[first_imsi]);
         
         // вывод результата
         if (!response.empty()) {
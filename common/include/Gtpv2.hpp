@@ -0,0 +1,249 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <optional>
+#include <string_view>
+#include "Imsi.hpp"
+
+namespace pgw {
+
+// GTPv2-C (3GPP TS 29.274): разбор без копирования прямо из буфера приема
+// и сборка ответа в буфер вызывающего. поддерживается подмножество,
+// нужное для Create/Delete Session и Echo. числа в сети - big-endian.
+
+enum class GtpMessageType : uint8_t {
+    ECHO_REQUEST = 1,
+    ECHO_RESPONSE = 2,
+    CREATE_SESSION_REQUEST = 32,
+    CREATE_SESSION_RESPONSE = 33,
+    DELETE_SESSION_REQUEST = 36,
+    DELETE_SESSION_RESPONSE = 37
+};
+
+enum class GtpIeType : uint8_t {
+    IMSI = 1,
+    CAUSE = 2,
+    RECOVERY = 3,
+    EBI = 73,
+    F_TEID = 87
+};
+
+enum class GtpCause : uint8_t {
+    REQUEST_ACCEPTED = 16,
+    CONTEXT_NOT_FOUND = 64,
+    INVALID_MESSAGE_FORMAT = 65,
+    MANDATORY_IE_MISSING = 70,
+    NO_RESOURCES_AVAILABLE = 73,
+    USER_AUTHENTICATION_FAILED = 92
+};
+
+// тип интерфейса в F-TEID: S5/S8 PGW GTP-C
+constexpr uint8_t kFteidS5S8PgwGtpC = 7;
+
+constexpr uint8_t kGtpVersion = 2;
+constexpr size_t kGtpMinHeaderSize = 8;   // без TEID
+constexpr size_t kGtpIeHeaderSize = 4;    // тип, длина (2), instance
+
+// версия в старших трех битах первого байта: 0x40..0x5F,
+// не пересекается ни с цифрами ASCII, ни с бинарным протоколом
+inline bool is_gtpv2_packet(std::string_view data) {
+    return !data.empty() && (static_cast<uint8_t>(data[0]) >> 5) == kGtpVersion;
+}
+
+// информационный элемент: value указывает в буфер сообщения
+struct GtpIe {
+    uint8_t type;
+    uint8_t instance;
+    std::string_view value;
+};
+
+namespace gtp_detail {
+
+inline uint32_t read_be(const char* p, size_t bytes) {
+    uint32_t value = 0;
+    for (size_t i = 0; i < bytes; ++i) {
+        value = (value << 8) | static_cast<uint8_t>(p[i]);
+    }
+    return value;
+}
+
+inline void write_be(char* p, uint32_t value, size_t bytes) {
+    for (size_t i = bytes; i > 0; --i) {
+        p[i - 1] = static_cast<char>(value);
+        value >>= 8;
+    }
+}
+
+} // namespace gtp_detail
+
+// представление сообщения поверх чужого буфера; буфер должен жить дольше
+class GtpMessage {
+public:
+    // проверяем заголовок, длину и то, что IE точно покрывают тело сообщения
+    static std::optional<GtpMessage> parse(std::string_view data) noexcept {
+        if (data.size() < kGtpMinHeaderSize || !is_gtpv2_packet(data)) return std::nullopt;
+        
+        const uint8_t flags = static_cast<uint8_t>(data[0]);
+        const bool piggyback = flags & 0x10;
+        const size_t length = gtp_detail::read_be(data.data() + 2, 2);
+        // длина считается без первых 4 байт; за сообщением может идти
+        // только piggyback-сообщение
+        if (4 + length > data.size() || (!piggyback && 4 + length != data.size())) {
+            return std::nullopt;
+        }
+        
+        GtpMessage message;
+        message.has_teid_ = flags & 0x08;
+        const size_t header_size = message.has_teid_ ? 12 : 8;
+        if (4 + length < header_size) return std::nullopt;
+        
+        message.type_ = static_cast<uint8_t>(data[1]);
+        size_t offset = 4;
+        if (message.has_teid_) {
+            message.teid_ = gtp_detail::read_be(data.data() + 4, 4);
+            offset = 8;
+        }
+        message.sequence_ = gtp_detail::read_be(data.data() + offset, 3);
+        message.ies_ = data.substr(header_size, 4 + length - header_size);
+        
+        // IE должны точно укладываться в тело
+        for (size_t pos = 0; pos < message.ies_.size(); ) {
+            if (message.ies_.size() - pos < kGtpIeHeaderSize) return std::nullopt;
+            const size_t ie_length = gtp_detail::read_be(message.ies_.data() + pos + 1, 2);
+            if (message.ies_.size() - pos - kGtpIeHeaderSize < ie_length) return std::nullopt;
+            pos += kGtpIeHeaderSize + ie_length;
+        }
+        return message;
+    }
+    
+    uint8_t type() const { return type_; }
+    bool has_teid() const { return has_teid_; }
+    uint32_t teid() const { return teid_; }
+    uint32_t sequence() const { return sequence_; }
+    
+    // обход IE верхнего уровня: bool f(const GtpIe&), false прекращает обход
+    template <typename F>
+    void for_each_ie(F&& f) const {
+        for (size_t pos = 0; pos < ies_.size(); ) {
+            const size_t ie_length = gtp_detail::read_be(ies_.data() + pos + 1, 2);
+            const GtpIe ie{static_cast<uint8_t>(ies_[pos]),
+                           static_cast<uint8_t>(ies_[pos + 3] & 0x0F),
+                           ies_.substr(pos + kGtpIeHeaderSize, ie_length)};
+            if (!f(ie)) return;
+            pos += kGtpIeHeaderSize + ie_length;
+        }
+    }
+    
+    std::optional<GtpIe> find_ie(GtpIeType type, uint8_t instance = 0) const {
+        std::optional<GtpIe> found;
+        for_each_ie([&](const GtpIe& ie) {
+            if (ie.type == static_cast<uint8_t>(type) && ie.instance == instance) {
+                found = ie;
+                return false;
+            }
+            return true;
+        });
+        return found;
+    }
+    
+    std::optional<Imsi> imsi() const {
+        auto ie = find_ie(GtpIeType::IMSI);
+        if (!ie) return std::nullopt;
+        return Imsi::from_tbcd(reinterpret_cast<const uint8_t*>(ie->value.data()), ie->value.size());
+    }
+    
+    // TEID из F-TEID с заданным instance (0 - Sender F-TEID for Control Plane)
+    std::optional<uint32_t> fteid_teid(uint8_t instance = 0) const {
+        auto ie = find_ie(GtpIeType::F_TEID, instance);
+        if (!ie || ie->value.size() < 5) return std::nullopt;
+        return gtp_detail::read_be(ie->value.data() + 1, 4);
+    }
+
+private:
+    GtpMessage() = default;
+    
+    uint8_t type_ = 0;
+    bool has_teid_ = false;
+    uint32_t teid_ = 0;
+    uint32_t sequence_ = 0;
+    std::string_view ies_;
+};
+
+// сборка сообщения в буфер вызывающего; при нехватке места ok() == false
+class GtpWriter {
+public:
+    GtpWriter(char* buffer, size_t capacity, GtpMessageType type,
+              std::optional<uint32_t> teid, uint32_t sequence)
+        : buffer_(buffer), capacity_(capacity) {
+        const size_t header_size = teid ? 12 : 8;
+        if (capacity_ < header_size) {
+            ok_ = false;
+            return;
+        }
+        buffer_[0] = static_cast<char>((kGtpVersion << 5) | (teid ? 0x08 : 0));
+        buffer_[1] = static_cast<char>(type);
+        size_t offset = 4;
+        if (teid) {
+            gtp_detail::write_be(buffer_ + 4, *teid, 4);
+            offset = 8;
+        }
+        gtp_detail::write_be(buffer_ + offset, sequence, 3);
+        buffer_[offset + 3] = 0;
+        size_ = header_size;
+    }
+    
+    void add_ie(GtpIeType type, uint8_t instance, const void* value, size_t length) {
+        if (!ok_ || capacity_ - size_ < kGtpIeHeaderSize + length || length > 0xFFFF) {
+            ok_ = false;
+            return;
+        }
+        char* p = buffer_ + size_;
+        p[0] = static_cast<char>(type);
+        gtp_detail::write_be(p + 1, static_cast<uint32_t>(length), 2);
+        p[3] = static_cast<char>(instance & 0x0F);
+        std::memcpy(p + kGtpIeHeaderSize, value, length);
+        size_ += kGtpIeHeaderSize + length;
+    }
+    
+    void add_cause(GtpCause cause) {
+        const char value[2] = {static_cast<char>(cause), 0};
+        add_ie(GtpIeType::CAUSE, 0, value, sizeof(value));
+    }
+    
+    void add_imsi(Imsi imsi) {
+        uint8_t tbcd[Imsi::kTbcdSize];
+        imsi.to_tbcd(tbcd);
+        add_ie(GtpIeType::IMSI, 0, tbcd, (imsi.length() + 1) / 2);
+    }
+    
+    // F-TEID с IPv4 адресом (ipv4 в сетевом порядке байт)
+    void add_fteid(uint8_t instance, uint8_t interface_type, uint32_t teid, uint32_t ipv4) {
+        char value[9];
+        value[0] = static_cast<char>(0x80 | (interface_type & 0x3F));
+        gtp_detail::write_be(value + 1, teid, 4);
+        std::memcpy(value + 5, &ipv4, 4);
+        add_ie(GtpIeType::F_TEID, instance, value, sizeof(value));
+    }
+    
+    void add_recovery(uint8_t restart_counter) {
+        add_ie(GtpIeType::RECOVERY, 0, &restart_counter, 1);
+    }
+    
+    bool ok() const { return ok_; }
+    
+    // проставляем длину и возвращаем готовое сообщение (пустое при переполнении)
+    std::string_view finish() {
+        if (!ok_) return {};
+        gtp_detail::write_be(buffer_ + 2, static_cast<uint32_t>(size_ - 4), 2);
+        return std::string_view(buffer_, size_);
+    }
+
+private:
+    char* buffer_;
+    size_t capacity_;
+    size_t size_ = 0;
+    bool ok_ = true;
+};
+
+} // namespace pgw
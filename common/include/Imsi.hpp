@@ -0,0 +1,138 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <spdlog/fmt/fmt.h>
+
+namespace pgw {
+
+// IMSI, упакованный в 64 бита: до 15 десятичных цифр в BCD,
+// первая цифра - в старшем полубайте, длина - в младшем.
+// сравнение чисел совпадает с лексикографическим сравнением строк,
+// а общий префикс цифр дает общие старшие биты
+class Imsi {
+public:
+    static constexpr size_t kMaxDigits = 15;
+    static constexpr size_t kTbcdSize = 8;  // 15 цифр + заполнитель
+
+    constexpr Imsi() = default;  // пустой (невалидный) IMSI
+
+    // неявные конструкторы из строки для конфигов, HTTP и тестов;
+    // бросают std::invalid_argument, на горячем пути используем parse()
+    Imsi(std::string_view digits) {
+        auto parsed = parse(digits);
+        if (!parsed) {
+            throw std::invalid_argument("неверный IMSI: " + std::string(digits));
+        }
+        raw_ = parsed->raw_;
+    }
+    Imsi(const std::string& digits) : Imsi(std::string_view(digits)) {}
+    Imsi(const char* digits) : Imsi(std::string_view(digits)) {}
+
+    // разбор без исключений и аллокаций: 1..15 десятичных цифр
+    static std::optional<Imsi> parse(std::string_view digits) noexcept {
+        if (digits.empty() || digits.size() > kMaxDigits) return std::nullopt;
+        uint64_t raw = 0;
+        for (size_t i = 0; i < digits.size(); ++i) {
+            const unsigned d = static_cast<unsigned char>(digits[i]) - '0';
+            if (d > 9) return std::nullopt;
+            raw |= uint64_t(d) << (60 - 4 * i);
+        }
+        return from_raw(raw | digits.size());
+    }
+
+    static constexpr Imsi from_raw(uint64_t raw) noexcept {
+        Imsi imsi;
+        imsi.raw_ = raw;
+        return imsi;
+    }
+
+    constexpr uint64_t raw() const noexcept { return raw_; }
+    constexpr size_t length() const noexcept { return raw_ & 0xF; }
+    constexpr bool valid() const noexcept { return length() != 0; }
+    constexpr unsigned digit(size_t i) const noexcept { return (raw_ >> (60 - 4 * i)) & 0xF; }
+
+    // пишем цифры в буфер размером не меньше kMaxDigits, возвращаем длину
+    size_t to_chars(char* out) const noexcept {
+        const size_t len = length();
+        for (size_t i = 0; i < len; ++i) {
+            out[i] = static_cast<char>('0' + digit(i));
+        }
+        return len;
+    }
+
+    // TBCD (3GPP TS 29.002): две цифры на байт, первая - в младшем полубайте,
+    // неиспользуемые полубайты - 0xF. пишем ровно kTbcdSize байт
+    void to_tbcd(uint8_t* out) const noexcept {
+        const size_t len = length();
+        for (size_t i = 0; i < kTbcdSize; ++i) {
+            const unsigned lo = 2 * i < len ? digit(2 * i) : 0xF;
+            const unsigned hi = 2 * i + 1 < len ? digit(2 * i + 1) : 0xF;
+            out[i] = static_cast<uint8_t>(lo | (hi << 4));
+        }
+    }
+    
+    // разбор TBCD без исключений: цифры до первого 0xF, дальше только 0xF
+    static std::optional<Imsi> from_tbcd(const uint8_t* data, size_t size) noexcept {
+        uint64_t raw = 0;
+        size_t len = 0;
+        bool filler = false;
+        for (size_t i = 0; i < 2 * size; ++i) {
+            const unsigned d = i % 2 == 0 ? data[i / 2] & 0xF : data[i / 2] >> 4;
+            if (d == 0xF) {
+                filler = true;
+                continue;
+            }
+            if (filler || d > 9 || len == kMaxDigits) return std::nullopt;
+            raw |= uint64_t(d) << (60 - 4 * len);
+            ++len;
+        }
+        if (len == 0) return std::nullopt;
+        return from_raw(raw | len);
+    }
+    
+    std::string to_string() const {
+        char buf[kMaxDigits];
+        return std::string(buf, to_chars(buf));
+    }
+
+    friend constexpr bool operator==(Imsi a, Imsi b) noexcept { return a.raw_ == b.raw_; }
+    friend constexpr bool operator!=(Imsi a, Imsi b) noexcept { return a.raw_ != b.raw_; }
+    friend constexpr bool operator<(Imsi a, Imsi b) noexcept { return a.raw_ < b.raw_; }
+
+private:
+    uint64_t raw_ = 0;
+};
+
+} // namespace pgw
+
+namespace std {
+
+template <>
+struct hash<pgw::Imsi> {
+    size_t operator()(pgw::Imsi imsi) const noexcept {
+        // перемешиваем биты (finalizer из splitmix64): у BCD младшие
+        // полубайты почти не меняются, а корзины выбираются по ним
+        uint64_t x = imsi.raw();
+        x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ull;
+        x = (x ^ (x >> 27)) * 0x94D049BB133111EBull;
+        return x ^ (x >> 31);
+    }
+};
+
+} // namespace std
+
+// форматирование для spdlog без промежуточной std::string
+template <>
+struct fmt::formatter<pgw::Imsi> : fmt::formatter<std::string_view> {
+    template <typename FormatContext>
+    auto format(pgw::Imsi imsi, FormatContext& ctx) const {
+        char buf[pgw::Imsi::kMaxDigits];
+        return fmt::formatter<std::string_view>::format(
+            std::string_view(buf, imsi.to_chars(buf)), ctx);
+    }
+};
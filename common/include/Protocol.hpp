@@ -0,0 +1,152 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "Imsi.hpp"
+
+namespace pgw {
+
+// компактный бинарный протокол (версия 1), работает рядом с текстовым:
+// первый байт kProtocolMagic не может быть цифрой ASCII IMSI.
+//
+// заголовок, 8 байт:
+//   [0]     kProtocolMagic
+//   [1]     версия (kProtocolVersion)
+//   [2]     PacketType
+//   [3]     число IMSI в пакете N (1..255)
+//   [4..8)  номер запроса (seq), little-endian; в ответе - тот же
+// запрос:  заголовок + N x 8 байт IMSI в TBCD
+// ответ:   заголовок + N x 1 байт ResultCode, в порядке IMSI запроса;
+//          тип ответа - тип запроса + 1
+//
+// текстовый протокол: "<IMSI>" - создание, "delete <IMSI>" - удаление,
+// "refresh <IMSI>" - продление сессии
+constexpr uint8_t kProtocolMagic = 0xA1;
+constexpr uint8_t kProtocolVersion = 1;
+constexpr size_t kPacketHeaderSize = 8;
+constexpr size_t kMaxImsisPerPacket = 255;
+constexpr size_t kMaxRequestSize = kPacketHeaderSize + kMaxImsisPerPacket * Imsi::kTbcdSize;
+constexpr size_t kMaxResponseSize = kPacketHeaderSize + kMaxImsisPerPacket;
+
+enum class PacketType : uint8_t {
+    CREATE_REQUEST = 1,
+    CREATE_RESPONSE = 2,
+    DELETE_REQUEST = 3,
+    DELETE_RESPONSE = 4,
+    REFRESH_REQUEST = 5,   // продление: сессия считается активной с этого момента
+    REFRESH_RESPONSE = 6
+};
+
+enum class ResultCode : uint8_t {
+    CREATED = 0,
+    EXISTS = 1,
+    REJECTED_BLACKLIST = 2,
+    REJECTED_LIMIT = 3,
+    INVALID_IMSI = 4,
+    DELETED = 5,
+    REFRESHED = 6,
+    NOT_FOUND = 7          // удаление или продление несуществующей сессии
+};
+
+constexpr std::string_view kTextDeleteCommand = "delete ";
+constexpr std::string_view kTextRefreshCommand = "refresh ";
+
+inline bool is_request(PacketType type) {
+    return type == PacketType::CREATE_REQUEST || type == PacketType::DELETE_REQUEST ||
+           type == PacketType::REFRESH_REQUEST;
+}
+
+inline PacketType response_type(PacketType request) {
+    return static_cast<PacketType>(static_cast<uint8_t>(request) + 1);
+}
+
+// команда текстового протокола для типа запроса
+inline std::string_view text_command(PacketType request) {
+    switch (request) {
+        case PacketType::DELETE_REQUEST: return kTextDeleteCommand;
+        case PacketType::REFRESH_REQUEST: return kTextRefreshCommand;
+        default: return {};
+    }
+}
+
+inline std::string_view to_string(ResultCode code) {
+    switch (code) {
+        case ResultCode::CREATED: return "created";
+        case ResultCode::EXISTS: return "exists";
+        case ResultCode::REJECTED_BLACKLIST: return "rejected_blacklist";
+        case ResultCode::REJECTED_LIMIT: return "rejected_limit";
+        case ResultCode::INVALID_IMSI: return "invalid_imsi";
+        case ResultCode::DELETED: return "deleted";
+        case ResultCode::REFRESHED: return "refreshed";
+        case ResultCode::NOT_FOUND: return "not_found";
+    }
+    return "unknown";
+}
+
+struct PacketHeader {
+    PacketType type;
+    uint8_t count;
+    uint32_t seq;
+};
+
+inline bool is_binary_packet(std::string_view data) {
+    return !data.empty() && static_cast<uint8_t>(data[0]) == kProtocolMagic;
+}
+
+inline void encode_header(char* out, const PacketHeader& header) {
+    out[0] = static_cast<char>(kProtocolMagic);
+    out[1] = static_cast<char>(kProtocolVersion);
+    out[2] = static_cast<char>(header.type);
+    out[3] = static_cast<char>(header.count);
+    for (size_t i = 0; i < 4; ++i) {
+        out[4 + i] = static_cast<char>(header.seq >> (8 * i));
+    }
+}
+
+// проверяем заголовок и соответствие размера пакета числу записей
+inline std::optional<PacketHeader> decode_header(std::string_view data) {
+    if (data.size() < kPacketHeaderSize || !is_binary_packet(data) ||
+        static_cast<uint8_t>(data[1]) != kProtocolVersion) {
+        return std::nullopt;
+    }
+    const auto* bytes = reinterpret_cast<const uint8_t*>(data.data());
+    PacketHeader header{static_cast<PacketType>(bytes[2]), bytes[3], 0};
+    for (size_t i = 0; i < 4; ++i) {
+        header.seq |= uint32_t(bytes[4 + i]) << (8 * i);
+    }
+    
+    size_t item_size = 0;
+    switch (header.type) {
+        case PacketType::CREATE_REQUEST:
+        case PacketType::DELETE_REQUEST:
+        case PacketType::REFRESH_REQUEST:
+            item_size = Imsi::kTbcdSize;
+            break;
+        case PacketType::CREATE_RESPONSE:
+        case PacketType::DELETE_RESPONSE:
+        case PacketType::REFRESH_RESPONSE:
+            item_size = 1;
+            break;
+        default: return std::nullopt;
+    }
+    if (header.count == 0 || data.size() != kPacketHeaderSize + header.count * item_size) {
+        return std::nullopt;
+    }
+    return header;
+}
+
+// запрос для клиента; imsis.size() от 1 до kMaxImsisPerPacket
+inline std::string encode_request(uint32_t seq, const std::vector<Imsi>& imsis,
+                                  PacketType type = PacketType::CREATE_REQUEST) {
+    std::string packet(kPacketHeaderSize + imsis.size() * Imsi::kTbcdSize, '\0');
+    encode_header(packet.data(), {type, static_cast<uint8_t>(imsis.size()), seq});
+    for (size_t i = 0; i < imsis.size(); ++i) {
+        imsis[i].to_tbcd(reinterpret_cast<uint8_t*>(packet.data() + kPacketHeaderSize + i * Imsi::kTbcdSize));
+    }
+    return packet;
+}
+
+} // namespace pgw
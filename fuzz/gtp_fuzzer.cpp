@@ -0,0 +1,25 @@
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include "Gtpv2.hpp"
+#include "Protocol.hpp"
+
+// libFuzzer: разбор GTPv2-C из произвольных байт, как из сокета
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size) {
+    std::string_view packet(reinterpret_cast<const char*>(data), size);
+    auto message = pgw::GtpMessage::parse(packet);
+    if (!message) return 0;
+    
+    message->for_each_ie([](const pgw::GtpIe&) { return true; });
+    message->imsi();
+    message->fteid_teid(0);
+    
+    // ответ собирается в буфер того же размера, что и в UdpServer
+    char reply[pgw::kMaxResponseSize];
+    pgw::GtpWriter writer(reply, sizeof(reply), pgw::GtpMessageType::CREATE_SESSION_RESPONSE,
+                          message->teid(), message->sequence());
+    writer.add_cause(pgw::GtpCause::REQUEST_ACCEPTED);
+    if (auto imsi = message->imsi()) writer.add_imsi(*imsi);
+    writer.finish();
+    return 0;
+}
@@ -1,48 +1,30 @@
 #!/bin/bash
-# Скрипт нагрузочного тестирования системы 
-# Генерирует N параллельных запросов к серверу
+# Скрипт нагрузочного тестирования системы
+# Запускает pgw_loadgen: один процесс, пакетные sendmmsg/recvmmsg,
+# отчет о пропускной способности и задержках (p50/p99/p99.9)
+# Использование: ./load_test.sh [дополнительные параметры pgw_loadgen]
 
 SCRIPT_DIR="$( cd "$( dirname "${BASH_SOURCE[0]}" )" &> /dev/null && pwd )"
-RUN_CLIENT="$SCRIPT_DIR/run_client.sh"
-CONCURRENCY=5000  # количество параллельных запросов
-TOTAL_REQUESTS=10000 # общее количество запросов
-BLACKLIST_RATIO=15 # процент запросов из черного списка (целое число 0-100)
+BUILD_DIR="$SCRIPT_DIR/out/build/GCC 13.3.0 x86_64-linux-gnu"
+CONFIG_FILE="$SCRIPT_DIR/config/client_config.json"
+LOADGEN="$BUILD_DIR/client/pgw_loadgen"
 
-# Генератор IMSI
-generate_imsi() {
-    prefix="001010"
-    num=$(printf "%010d" $1)
-    echo "${prefix}${num}"
-}
+DURATION=10          # длительность теста, секунд
+RATE=0               # запросов в секунду, 0 - максимум
+THREADS=2            # потоков генератора
+SOCKETS=8            # сокетов на поток
+BLACKLIST_RATIO=0.15 # доля запросов из черного списка
 
-# запуск группы клиентов
-run_test_group() {
-    for i in $(seq 1 $1); do
-        # случайно выбираем, будет ли IMSI в черном списке
-        if (( RANDOM % 100 < BLACKLIST_RATIO )); then
-            imsi="001010123456789"  # IMSI из черного списка
-        else
-            imsi=$(generate_imsi $((RANDOM % 1000000)))
-        fi
-        
-        "$RUN_CLIENT" "$imsi" > /dev/null &
-    done
-    wait
-}
+if [ ! -f "$LOADGEN" ]; then
+    echo "Ошибка: pgw_loadgen не найден. Соберите проект сначала."
+    exit 1
+fi
 
-echo "Начало нагрузочного тестирования"
-echo "Параметры:"
-echo "  Параллельных запросов: $CONCURRENCY"
-echo "  Всего запросов: $TOTAL_REQUESTS"
-echo "  Процент черного списка: ${BLACKLIST_RATIO}%"
-
-# основной цикл тестирования
-groups=$((TOTAL_REQUESTS / CONCURRENCY))
-for group in $(seq 1 $groups); do
-    echo "Запуск группы $group/$groups ($CONCURRENCY запросов)..."
-    run_test_group $CONCURRENCY
-    sleep 0.5  
-done
-
-echo "Нагрузочное тестирование завершено"
-echo "Проверьте логи сервера и CDR для анализа производительности"
+"$LOADGEN" "$CONFIG_FILE" \
+    --duration "$DURATION" \
+    --rate "$RATE" \
+    --threads "$THREADS" \
+    --sockets "$SOCKETS" \
+    --blacklist-ratio "$BLACKLIST_RATIO" \
+    --blacklist-imsi 001010123456789 \
+    "$@"
@@ -0,0 +1,83 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+#include "Imsi.hpp"
+
+namespace pgw {
+
+// черный список IMSI: точные IMSI, префиксы ("25001*" - вся сеть MCC/MNC)
+// и диапазоны ("250010000000000-250010000999999", границы включительно,
+// порядок - лексикографический, как у строк цифр).
+//
+// точные IMSI и префиксы хранятся в отсортированных массивах упакованных
+// значений, перед ними - блочный фильтр Блума (одна строка кеша на ключ),
+// а префиксы еще и за битовой картой первых kHeadDigits цифр (MCC+MNC):
+// для IMSI не из списка обычно хватает одной проверки фильтра.
+// после сборки (конструктор или build()) только чтение, потокобезопасен
+class Blacklist {
+public:
+    Blacklist() = default;
+    // записи из конфигурации; бросает std::invalid_argument на неверной записи
+    template <typename Range>
+    explicit Blacklist(const Range& entries) {
+        for (const auto& entry : entries) add(entry);
+        build();
+    }
+
+    // разбор одной записи; бросает std::invalid_argument
+    void add(std::string_view entry);
+    // загрузка файла (по записи в строке, '#' - комментарий) через mmap,
+    // разбор в threads потоков (0 - по числу ядер). неверные строки
+    // пропускаются с предупреждением; бросает std::runtime_error, если
+    // файл не открывается. возвращает число загруженных записей
+    size_t load_file(const std::string& path, unsigned threads = 0);
+    // сортировка, удаление дубликатов и построение фильтра;
+    // вызывается после add()/load_file() и до contains()
+    void build();
+
+    bool contains(Imsi imsi) const;
+
+    size_t exact_count() const { return exact_.size(); }
+    size_t prefix_count() const { return prefixes_.size(); }
+    size_t range_count() const { return ranges_.size(); }
+    bool empty() const { return exact_.empty() && prefixes_.empty() && ranges_.empty(); }
+    size_t filter_bytes() const { return filter_.size() * sizeof(FilterBlock); }
+
+private:
+    static constexpr unsigned kHeadDigits = 5;
+    static constexpr uint32_t kHeadCount = 100000;  // 10^kHeadDigits
+
+    // фильтр Блума из блоков по строке кеша: все биты ключа в одном блоке
+    struct alignas(64) FilterBlock {
+        uint64_t words[8];
+    };
+
+    struct Entries {
+        std::vector<uint64_t> exact;     // Imsi::raw()
+        std::vector<uint64_t> prefixes;  // Imsi::raw() префикса, длина - длина префикса
+        std::vector<std::pair<uint64_t, uint64_t>> ranges;
+        uint16_t prefix_lengths = 0;     // бит i - есть префиксы длины i
+    };
+
+    // false - запись неверна
+    static bool parse_entry(std::string_view entry, Entries& out);
+    static size_t parse_chunk(std::string_view text, Entries& out);  // число неверных строк
+    void merge(Entries&& part);
+
+    void filter_add(uint64_t hash);
+    bool filter_may_contain(uint64_t hash) const;
+
+    std::vector<uint64_t> exact_;
+    std::vector<uint64_t> prefixes_;
+    std::vector<std::pair<uint64_t, uint64_t>> ranges_;  // без пересечений, по возрастанию
+    uint16_t prefix_lengths_ = 0;
+    std::vector<uint64_t> prefix_heads_;  // бит - есть префикс с такими первыми цифрами
+    std::vector<FilterBlock> filter_;
+    uint64_t filter_mask_ = 0;
+};
+
+} // namespace pgw
@@ -1,25 +1,83 @@
 #pragma once
-#include <fstream>
-#include <mutex>
-#include <iomanip>
+#include <atomic>
 #include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include "CdrRecord.hpp"
+#include "Imsi.hpp"
+#include "MpscRing.hpp"
 
 namespace pgw {
 
+struct CdrOptions {
+    size_t queue_size = 65536;          // записей в кольцевом буфере
+    unsigned flush_interval_ms = 200;   // максимальная задержка записи на диск
+    bool fsync = false;                 // fsync после каждой пачки
+    bool block_when_full = true;        // false - отбрасываем запись и считаем потерю
+    CdrFormat format = CdrFormat::CSV;
+    uint64_t rotate_bytes = 0;          // ротация по размеру файла (0 - выключена)
+    unsigned rotate_interval_sec = 0;   // ротация по времени (0 - выключена)
+    bool timestamp_millis = false;      // миллисекунды во времени CSV
+};
+
 class CDRLogger {
 public:
-    // создаем логгер с указанием файла для записи CDR
-    explicit CDRLogger(const std::string& filename);
+    // создаем логгер с указанием файла для записи CDR и запускаем поток записи
+    explicit CDRLogger(const std::string& filename, const CdrOptions& options = {});
+    ~CDRLogger();
     
-    // записываем событие в лог: IMSI + действие (created, rejected, expired)
-    void log(const std::string& imsi, const std::string& action);
+    // ставим событие в очередь: IMSI + действие; не блокирует и не пишет в файл
+    void log(Imsi imsi, CdrAction action);
+    
+    // ждем, пока все поставленные до вызова записи окажутся в файле
+    void flush();
+    
+    uint64_t written() const { return written_.load(std::memory_order_relaxed); }
+    // потеряно записей: переполнение очереди или ошибка записи при остановке
+    uint64_t dropped() const {
+        return dropped_.load(std::memory_order_relaxed) + lost_.load(std::memory_order_relaxed);
+    }
+    size_t queue_depth() const { return queue_.size(); }
+    uint64_t rotations() const { return rotations_.load(std::memory_order_relaxed); }
     
 private:
-    // генерируем текущее время в читаемом формате
-    std::string current_time() const;
+    void writer_loop();
+    // забираем записи из очереди и форматируем их в буфер, возвращаем число записей
+    size_t drain(std::string& buffer);
+    // false - запись не удалась, файл обрезан до последней целой записи
+    bool write_out(std::string_view buffer);
+    // пишем заголовок, если файл пустой
+    bool write_header();
+    // открываем файл и пишем заголовок, если он пустой
+    void open_file();
+    // переименовываем текущий файл (атомарно) и начинаем новый
+    void rotate();
+    bool rotation_due(size_t incoming_bytes) const;
+    
+    const std::string filename_;
+    int fd_ = -1;                  // файл CDR, открыт на добавление
+    uint64_t file_bytes_ = 0;      // размер текущего файла
+    uint64_t file_records_ = 0;    // записей в текущем файле
+    std::chrono::steady_clock::time_point file_opened_at_;
+    const CdrOptions options_;
+    TimestampCache timestamps_;    // используется только потоком записи
+    MpscRing<CdrRecord> queue_;
+    
+    std::atomic<uint64_t> written_{0};
+    std::atomic<uint64_t> dropped_{0};     // переполнение очереди
+    std::atomic<uint64_t> lost_{0};        // не записаны из-за ошибок диска
+    std::atomic<uint64_t> rotations_{0};
+    std::atomic<bool> running_{true};
+    std::atomic<bool> flush_requested_{false};
     
-    std::ofstream file_;     // файловый поток для записи
-    mutable std::mutex mutex_; // защита для многопоточного доступа
+    std::mutex wake_mutex_;              // только для ожидания, не для записи
+    std::condition_variable wake_cv_;    // будим поток записи
+    std::condition_variable flushed_cv_; // сообщаем о записанной пачке
+    std::thread writer_;
 };
 
-} // namespace pgw
\ No newline at end of file
+} // namespace pgw
@@ -0,0 +1,54 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include "TimestampCache.hpp"
+
+namespace pgw {
+
+// действие, попадающее в CDR
+enum class CdrAction : uint8_t {
+    CREATED,
+    EXISTS,
+    REJECTED,
+    EXPIRED,
+    GRACEFUL_REMOVE,
+    DELETED,         // явное удаление: запрос delete или GTPv2-C Delete Session
+    REFRESHED
+};
+
+std::string_view to_string(CdrAction action);
+
+// формат файла CDR
+enum class CdrFormat {
+    CSV,     // timestamp,imsi,action - как раньше
+    BINARY   // заголовок kCdrBinaryMagic + записи по kCdrBinaryRecordSize байт
+};
+
+// запись фиксированного размера: так она лежит в очереди CDRLogger
+struct CdrRecord {
+    int64_t timestamp_ns;  // system_clock
+    uint64_t imsi;         // Imsi::raw()
+    CdrAction action;
+};
+
+// бинарная запись, little-endian:
+//   [0..8)   IMSI, упакованный как Imsi::raw()
+//   [8..14)  время в миллисекундах от эпохи Unix (48 бит)
+//   [14]     CdrAction
+//   [15]     резерв (0)
+constexpr size_t kCdrBinaryRecordSize = 16;
+constexpr std::string_view kCdrBinaryMagic{"PGWCDR\x01\n", 8};  // версия 1
+constexpr std::string_view kCdrCsvHeader{"timestamp,imsi,action\n"};
+
+void append_binary(std::string& out, const CdrRecord& record);
+// nullopt - неизвестное действие (поврежденная запись)
+std::optional<CdrRecord> decode_binary(const char* data);
+
+// строка CSV: "YYYY-MM-DD HH:MM:SS[.mmm],IMSI,action\n" в локальном времени,
+// время берется из кеша, который писатель держит между записями
+void append_csv(std::string& out, const CdrRecord& record, TimestampCache& timestamps);
+
+} // namespace pgw
@@ -4,9 +4,17 @@
 #include <string>
 #include <vector>
 #include <cstdint>
+#include "CdrRecord.hpp"
+#include "UdpBackend.hpp"
 
 namespace pgw {
 
+// поведение при заполнении очереди
+enum class OverflowPolicy {
+    BLOCK,  // ждать места
+    DROP    // терять (CDR) или вытеснять старые (лог) записи
+};
+
 struct ServerConfig {
     std::string udp_ip;
     uint16_t udp_port;
@@ -17,10 +25,40 @@ struct ServerConfig {
     std::string log_file;
     std::string log_level;
     std::vector<std::string> blacklist;
+    std::string blacklist_file;  // внешний черный список (пусто - только blacklist)
+    unsigned blacklist_load_threads; // потоки разбора файла (0 - по числу ядер)
     unsigned max_sessions;
+    unsigned udp_batch_size;   // датаграмм за один recvmmsg/sendmmsg (1 - классический цикл)
+    unsigned udp_workers;      // число воркеров с SO_REUSEPORT сокетами
+    std::vector<int> udp_cpu_affinity; // CPU для воркеров (пусто - без привязки)
+    UdpBackend udp_backend;    // "epoll" или "io_uring" (сборка с PGW_WITH_IO_URING)
+    unsigned session_shards;   // число сегментов таблицы сессий (степень двойки)
+    unsigned expiry_tick_ms;   // минимальный интервал между очистками истекших сессий
+    unsigned cdr_queue_size;   // емкость очереди CDR (записей)
+    unsigned cdr_flush_interval_ms; // максимальная задержка записи CDR на диск
+    bool cdr_fsync;            // fsync после каждой пачки CDR
+    OverflowPolicy cdr_overflow; // "block" - ждать места в очереди, "drop" - терять записи биллинга
+    CdrFormat cdr_format;      // "csv" или "binary"
+    uint64_t cdr_rotate_bytes; // ротация CDR по размеру (0 - выключена)
+    unsigned cdr_rotate_interval_sec; // ротация CDR по времени (0 - выключена)
+    bool cdr_timestamp_millis; // миллисекунды во времени CDR
+    std::string state_dir;     // каталог снимка и журнала сессий (пусто - без сохранения)
+    unsigned snapshot_interval_sec; // период снимков таблицы сессий
+    bool journal_fsync;        // fdatasync журнала сессий после каждой пачки
+    unsigned http_threads;     // пул обработчиков HTTP API
+    unsigned http_keep_alive_max_count; // запросов на одно keep-alive соединение
+    unsigned http_keep_alive_timeout_sec; // простой keep-alive соединения
+    unsigned http_read_timeout_ms;
+    unsigned http_write_timeout_ms;
+    std::vector<int> http_cpu_affinity; // CPU для потоков HTTP (пусто - без привязки)
+    bool log_async;            // асинхронная запись лога
+    unsigned log_queue_size;   // очередь асинхронного логгера (сообщений)
+    OverflowPolicy log_overflow; // "block" - ждать, "drop" - вытеснять старые сообщения
+    unsigned log_flush_interval_sec; // период flush лога (warn и выше - сразу)
+    unsigned log_sample_per_sec; // лимит сообщений о запросах с одного места (0 - все)
 };
 
-// объявление функции
+// объявление функции; неизвестные значения перечислений - std::runtime_error
 ServerConfig load_server_config(const std::string& file_path);
 
 } // namespace pgw
\ No newline at end of file
@@ -0,0 +1,71 @@
+#pragma once
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string_view>
+#include <thread>
+#include "SessionManager.hpp"
+#include "CDRLogger.hpp"
+
+namespace pgw {
+
+struct DrainStatus {
+    enum class State {
+        IDLE,       // не запускался
+        RUNNING,
+        COMPLETED,  // все сессии удалены
+        CANCELLED
+    };
+    
+    State state = State::IDLE;
+    unsigned rate = 0;        // сессий в секунду, 0 - без ограничения
+    uint64_t removed = 0;     // удалено этим запуском
+    unsigned remaining = 0;   // активных сессий сейчас
+    double elapsed_sec = 0;
+};
+
+std::string_view to_string(DrainStatus::State state);
+
+// фоновое удаление всех сессий с заданной скоростью (graceful shutdown).
+// скорость держится маркерным ведром с тиком kTick: за тик снимается
+// накопленное число сессий одной пачкой через SessionManager::drain_batch,
+// запас ведра - не больше 100 мс работы, чтобы не было рывков.
+// на время работы прием новых сессий закрыт; отмена открывает его снова
+class DrainScheduler {
+public:
+    static constexpr std::chrono::milliseconds kTick{10};
+    
+    DrainScheduler(SessionManager& session_manager, CDRLogger& cdr_logger);
+    ~DrainScheduler();  // отменяет незавершенное удаление
+    
+    DrainScheduler(const DrainScheduler&) = delete;
+    DrainScheduler& operator=(const DrainScheduler&) = delete;
+    
+    // false - удаление уже идет. on_complete вызывается из потока
+    // удаления, когда сессий не осталось (не вызывается при отмене)
+    bool start(unsigned rate, std::function<void()> on_complete = {});
+    // false - удаление не идет
+    bool cancel();
+    // ждем завершения или отмены
+    void wait();
+    DrainStatus status() const;
+
+private:
+    void run(std::function<void()> on_complete);
+    
+    SessionManager& session_manager_;
+    CDRLogger& cdr_logger_;
+    
+    mutable std::mutex mutex_;
+    std::condition_variable cv_;     // будим поток при отмене
+    DrainStatus::State state_ = DrainStatus::State::IDLE;
+    unsigned rate_ = 0;
+    uint64_t removed_ = 0;
+    std::chrono::steady_clock::time_point started_at_;
+    std::chrono::steady_clock::time_point finished_at_;
+    std::thread thread_;
+};
+
+} // namespace pgw
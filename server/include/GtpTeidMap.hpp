@@ -0,0 +1,64 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <unordered_map>
+#include <vector>
+#include "Imsi.hpp"
+
+namespace pgw {
+
+class SessionManager;
+
+// соответствие локальных TEID управляющего уровня GTPv2-C и сессий.
+// сегментирован как SessionManager; номер сегмента зашит в младшие биты
+// TEID, поэтому поиск и по IMSI, и по TEID берет одну блокировку.
+// узлы хеш-таблиц выделяются в конструкторе и после удаления привязки
+// возвращаются в запас сегмента: bind() на горячем пути не аллоцирует,
+// пока привязок не больше capacity
+class GtpTeidMap {
+public:
+    struct Binding {
+        Imsi imsi;
+        uint32_t peer_teid;  // TEID управляющего уровня MME/SGW
+    };
+    
+    // capacity - ожидаемое число привязок (max_sessions), 0 - без предвыделения
+    explicit GtpTeidMap(unsigned shards = 16, unsigned capacity = 0);
+    
+    // TEID для IMSI: уже выданный или новый (не 0); peer_teid обновляется
+    uint32_t bind(Imsi imsi, uint32_t peer_teid);
+    std::optional<Binding> find(uint32_t teid) const;
+    // удаляем привязку и возвращаем ее
+    std::optional<Binding> release(uint32_t teid);
+    // убираем привязки сессий, которые истекли или удалены в обход GTP
+    size_t prune(const SessionManager& session_manager);
+    size_t size() const;
+
+private:
+    using TeidIndex = std::unordered_map<uint32_t, Binding>;
+    using ImsiIndex = std::unordered_map<Imsi, uint32_t>;
+    
+    struct alignas(64) Shard {
+        mutable std::mutex mutex;
+        TeidIndex by_teid;
+        ImsiIndex by_imsi;
+        // узлы удаленных привязок для повторного использования
+        std::vector<TeidIndex::node_type> spare_teids;
+        std::vector<ImsiIndex::node_type> spare_imsis;
+        uint32_t next_id = 1;  // старшие биты следующего TEID
+    };
+    
+    Shard& shard_for(Imsi imsi);
+    // вставка и удаление под блокировкой сегмента, узлы - из запаса и в запас
+    static void insert(Shard& shard, uint32_t teid, const Binding& binding);
+    static void erase(Shard& shard, TeidIndex::iterator it);
+    
+    unsigned shard_bits_ = 0;
+    std::unique_ptr<Shard[]> shards_;
+};
+
+} // namespace pgw
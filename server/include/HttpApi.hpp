@@ -1,35 +1,58 @@
 #pragma once
 #include "SessionManager.hpp"
 #include "CDRLogger.hpp"
+#include "DrainScheduler.hpp"
 #include <httplib.h>
 #include <atomic>
+#include <functional>
 #include <memory>
 #include <thread>
+#include <vector>
 
 namespace pgw {
 
+struct HttpOptions {
+    unsigned threads = 4;                  // пул обработчиков запросов
+    size_t keep_alive_max_count = 100;     // запросов на одно соединение
+    unsigned keep_alive_timeout_sec = 5;   // простой keep-alive соединения
+    unsigned read_timeout_ms = 5000;
+    unsigned write_timeout_ms = 5000;
+    std::vector<int> cpu_affinity;         // CPU для потоков HTTP (пусто - без привязки)
+};
+
 class HttpApi {
 public:
     HttpApi(uint16_t port, 
             SessionManager& session_manager,
             CDRLogger& cdr_logger,
             std::atomic<bool>& shutdown_requested,
-            unsigned graceful_shutdown_rate);
+            unsigned graceful_shutdown_rate,
+            const HttpOptions& options = {});
     
     ~HttpApi();
     
     void run();
     void stop();
+    
+    // обработчик /reload: перечитывает конфигурацию, при ошибке бросает
+    // исключение. задается до run()
+    void set_reload_handler(std::function<void()> handler) { reload_handler_ = std::move(handler); }
+    // вызывается после shutdown_requested = true, чтобы сразу разбудить
+    // основной цикл. задается до run()
+    void set_shutdown_handler(std::function<void()> handler) { shutdown_handler_ = std::move(handler); }
 
 private:
     void setup_routes();
-    void graceful_shutdown_handler();
     
     uint16_t port_;
     SessionManager& session_manager_;
     CDRLogger& cdr_logger_;
     std::atomic<bool>& shutdown_requested_;
     unsigned graceful_shutdown_rate_;
+    const HttpOptions options_;
+    DrainScheduler drain_;  // graceful shutdown: удаление сессий в фоне
+    std::function<void()> reload_handler_;
+    std::function<void()> shutdown_handler_;
     
     std::unique_ptr<httplib::Server> server_;
     std::thread server_thread_;
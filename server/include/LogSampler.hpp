@@ -0,0 +1,48 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <spdlog/spdlog.h>
+
+namespace pgw {
+
+// ограничение частоты сообщений одного места в коде: не больше rate()
+// сообщений в секунду, остальные только считаются и раз в секунду
+// выводятся одной сводной строкой. обычно экземпляр - статический объект
+// рядом с местом вывода; allow() потокобезопасен и не блокирует
+class LogSampler {
+public:
+    explicit LogSampler(const char* name, spdlog::level::level_enum level = spdlog::level::info);
+    ~LogSampler();
+
+    LogSampler(const LogSampler&) = delete;
+    LogSampler& operator=(const LogSampler&) = delete;
+
+    // true - сообщение нужно вывести, false - уровень отключен
+    // или лимит текущей секунды исчерпан
+    bool allow();
+
+    uint64_t suppressed_total() const { return suppressed_total_.load(std::memory_order_relaxed); }
+
+    // лимит для всех экземпляров, 0 - без ограничения
+    static void set_rate(unsigned per_sec) { rate_.store(per_sec, std::memory_order_relaxed); }
+    static unsigned rate() { return rate_.load(std::memory_order_relaxed); }
+
+    // выводим сводки закончившихся окон: без этого счетчик пропущенных
+    // сообщений ждал бы следующего сообщения того же места
+    static void report_all();
+
+private:
+    // начинаем новое окно, если текущее закончилось
+    void roll(int64_t now_ns);
+
+    const char* name_;
+    const spdlog::level::level_enum level_;
+    std::atomic<int64_t> window_start_ns_{0};
+    std::atomic<uint32_t> in_window_{0};
+    std::atomic<uint64_t> suppressed_{0};
+    std::atomic<uint64_t> suppressed_total_{0};
+
+    static std::atomic<unsigned> rate_;
+};
+
+} // namespace pgw
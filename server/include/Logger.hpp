@@ -1,12 +1,22 @@
 #pragma once
 #include <memory>
+#include <string>
 #include <spdlog/spdlog.h>
 
 namespace pgw {
 
+struct LoggerOptions {
+    bool async = true;                 // запись в файл и консоль в фоновом потоке
+    size_t queue_size = 8192;          // сообщений в очереди асинхронного логгера
+    bool block_when_full = true;       // false - вытеснять старые сообщения
+    unsigned flush_interval_sec = 1;   // периодический flush (warn и выше - сразу)
+    unsigned sample_per_sec = 100;     // сообщений в секунду с одного места (0 - все)
+};
+
 class Logger {
 public:
-    static void init(const std::string& log_file, const std::string& level);
+    static void init(const std::string& log_file, const std::string& level,
+                     const LoggerOptions& options = {});
 };
 
-} // namespace pgw
\ No newline at end of file
+} // namespace pgw
@@ -0,0 +1,53 @@
+#pragma once
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <cerrno>
+#include <string>
+#include <string_view>
+
+namespace pgw {
+
+// файл, отображенный в память только для чтения
+class MappedFile {
+public:
+    explicit MappedFile(const std::string& path) {
+        const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0) {
+            error_ = errno;
+            return;
+        }
+        struct stat st{};
+        if (fstat(fd, &st) != 0) {
+            error_ = errno;
+        } else if (st.st_size > 0) {
+            void* p = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (p != MAP_FAILED) {
+                madvise(p, st.st_size, MADV_SEQUENTIAL);
+                data_ = static_cast<const char*>(p);
+                size_ = st.st_size;
+            } else {
+                error_ = errno;
+            }
+        }
+        ::close(fd);
+    }
+    ~MappedFile() {
+        if (data_) munmap(const_cast<char*>(data_), size_);
+    }
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    // пустой файл открывается успешно, view() у него пустой
+    bool is_open() const { return error_ == 0; }
+    int error() const { return error_; }  // errno ошибки открытия
+    std::string_view view() const { return {data_, size_}; }
+
+private:
+    const char* data_ = nullptr;
+    size_t size_ = 0;
+    int error_ = 0;
+};
+
+} // namespace pgw
@@ -0,0 +1,88 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+namespace pgw {
+
+// счетчики сервера, экспортируются в /metrics
+enum class Metric : unsigned {
+    UDP_RECEIVED,        // принятые датаграммы
+    SESSION_CREATED,
+    SESSION_EXISTS,
+    REJECTED_BLACKLIST,
+    REJECTED_LIMIT,
+    REJECTED_INVALID,    // некорректный IMSI в запросе
+    SEND_ERRORS,         // неотправленные ответы
+    SESSION_EXPIRED,
+    SESSION_GRACEFUL_REMOVED,
+    SESSION_DELETED,     // явное удаление (delete или GTPv2-C Delete Session)
+    SESSION_REFRESHED,
+    MALFORMED_PACKETS,   // бинарные и GTP пакеты с неверным заголовком или размером
+    COUNT
+};
+
+// глобальные метрики процесса без блокировок на горячем пути.
+// значения разнесены по полосам (stripes), выровненным по кэш-линии:
+// каждый поток пишет в свою полосу, при чтении полосы суммируются
+class Metrics {
+public:
+    // границы корзин гистограммы времени обработки запроса, наносекунды
+    static constexpr std::array<uint64_t, 12> kLatencyBucketsNs{
+        1000, 2500, 5000, 10000, 25000, 50000,
+        100000, 250000, 500000, 1000000, 5000000, 10000000
+    };
+
+    static void increment(Metric metric, uint64_t n = 1) {
+        local_stripe().counters[static_cast<unsigned>(metric)].fetch_add(n, std::memory_order_relaxed);
+    }
+
+    static void observe_latency(std::chrono::nanoseconds latency) {
+        const uint64_t ns = latency.count() > 0 ? latency.count() : 0;
+        size_t bucket = 0;
+        while (bucket < kLatencyBucketsNs.size() && ns > kLatencyBucketsNs[bucket]) ++bucket;
+        Stripe& stripe = local_stripe();
+        stripe.buckets[bucket].fetch_add(1, std::memory_order_relaxed);
+        stripe.latency_sum_ns.fetch_add(ns, std::memory_order_relaxed);
+    }
+
+    // сумма по всем полосам; монотонна, но не атомарна относительно соседних счетчиков
+    static uint64_t value(Metric metric);
+
+    // все счетчики и гистограмма в текстовом формате Prometheus
+    static std::string render();
+
+    // одна метрика с HELP/TYPE, для значений, которые считаются при запросе
+    static void append_sample(std::string& out, std::string_view name, std::string_view type,
+                              std::string_view help, uint64_t value);
+
+private:
+    static constexpr size_t kStripes = 32;
+    static constexpr size_t kCounters = static_cast<size_t>(Metric::COUNT);
+
+    struct alignas(64) Stripe {
+        std::atomic<uint64_t> counters[kCounters] = {};
+        std::atomic<uint64_t> buckets[kLatencyBucketsNs.size() + 1] = {};  // последняя - +Inf
+        std::atomic<uint64_t> latency_sum_ns{0};
+    };
+
+    static Stripe& local_stripe() {
+        // полоса назначается потоку один раз, по кругу
+        thread_local Stripe& stripe =
+            stripes_[next_stripe_.fetch_add(1, std::memory_order_relaxed) % kStripes];
+        return stripe;
+    }
+
+    static Stripe stripes_[kStripes];
+    static std::atomic<size_t> next_stripe_;
+};
+
+// определения в заголовке, чтобы increment() встраивался в вызывающий код
+inline Metrics::Stripe Metrics::stripes_[Metrics::kStripes];
+inline std::atomic<size_t> Metrics::next_stripe_{0};
+
+} // namespace pgw
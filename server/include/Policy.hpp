@@ -0,0 +1,23 @@
+#pragma once
+#include <chrono>
+#include <memory>
+#include "Blacklist.hpp"
+
+namespace pgw {
+
+struct ServerConfig;
+
+// правила приема сессий, которые меняются без перезапуска.
+// после публикации в SessionManager не изменяется: перезагрузка собирает
+// новый экземпляр и подменяет указатель целиком
+struct Policy {
+    Blacklist blacklist;
+    unsigned max_sessions = 0;
+    std::chrono::seconds session_timeout{0};
+};
+
+// черный список (записи конфига и blacklist_file), max_sessions и
+// session_timeout_sec из конфигурации; исключения - как у Blacklist
+std::unique_ptr<const Policy> make_policy(const ServerConfig& config);
+
+} // namespace pgw
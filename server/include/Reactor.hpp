@@ -0,0 +1,66 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <initializer_list>
+#include <memory>
+#include <vector>
+
+namespace pgw {
+
+// цикл событий на epoll: готовность дескрипторов, таймеры (timerfd),
+// сигналы (signalfd) и пробуждение из других потоков (eventfd).
+// обработчики вызываются в потоке run(). add*() - до run() или из
+// обработчиков; arm_timer() - из любого потока, если таймеры больше не
+// добавляются; stop() - из любого потока и из обработчика сигнала
+class Reactor {
+public:
+    using Handler = std::function<void(uint32_t events)>;
+    using TimerId = size_t;
+
+    Reactor();  // бросает std::runtime_error
+    ~Reactor();
+
+    Reactor(const Reactor&) = delete;
+    Reactor& operator=(const Reactor&) = delete;
+
+    // events - маска EPOLLIN/EPOLLOUT, срабатывание по уровню
+    void add(int fd, uint32_t events, Handler handler);
+    // снимаем дескриптор с наблюдения (сам fd не закрывается); только вне run()
+    void remove(int fd);
+
+    // таймер создается выключенным; arm_timer(delay, interval) запускает его
+    // через delay и дальше каждые interval (0 - однократно), повторный
+    // вызов перезапускает, delay = 0 - выключает
+    TimerId add_timer(std::function<void()> callback);
+    void arm_timer(TimerId timer, std::chrono::nanoseconds delay,
+                   std::chrono::nanoseconds interval = std::chrono::nanoseconds(0));
+
+    // сигналы приходят в цикл через signalfd. их нужно заранее заблокировать
+    // во всех потоках: block_signals() в main до создания потоков
+    void add_signals(std::initializer_list<int> signals, std::function<void(int)> callback);
+    static void block_signals(std::initializer_list<int> signals);
+
+    // обрабатываем события до stop(); без событий поток спит в epoll_wait
+    void run();
+    void stop();
+    bool stopping() const { return stop_requested_.load(std::memory_order_acquire); }
+
+private:
+    struct Watch {
+        int fd;
+        bool owned;  // timerfd и signalfd закрываем сами
+        Handler handler;
+    };
+
+    Watch& watch(int fd, bool owned, uint32_t events, Handler handler);
+
+    int epoll_fd_ = -1;
+    int wake_fd_ = -1;
+    std::vector<std::unique_ptr<Watch>> watches_;
+    std::vector<int> timer_fds_;  // TimerId - индекс
+    std::atomic<bool> stop_requested_{false};
+};
+
+} // namespace pgw
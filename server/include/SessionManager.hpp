@@ -1,21 +1,47 @@
 #pragma once
 
-#include <unordered_map>
 #include <set>
+#include <vector>
 #include <mutex>
+#include <atomic>
 #include <chrono>
 #include <string>
 #include <memory>
+#include <optional>
+#include <utility>
 #include <spdlog/spdlog.h>
 #include <CDRLogger.hpp>
+#include "Imsi.hpp"
+#include "Policy.hpp"
+#include "SessionTable.hpp"
 
 namespace pgw {
 
+class SessionStore;
+
 class SessionManager {
 public:
+    // shards - число независимых сегментов таблицы (округляется до степени двойки).
+    // записи черного списка - IMSI, префиксы и диапазоны (см. Blacklist)
     SessionManager(unsigned timeout_sec, 
                    const std::set<std::string>& blacklist,
-                   unsigned max_sessions);
+                   unsigned max_sessions,
+                   unsigned shards = 16);
+    SessionManager(unsigned timeout_sec, 
+                   Blacklist blacklist,
+                   unsigned max_sessions,
+                   unsigned shards = 16);
+    // таблицы сегментов рассчитываются на policy->max_sessions
+    explicit SessionManager(std::unique_ptr<const Policy> policy, unsigned shards = 16);
+    
+    // горячая перезагрузка: новая политика публикуется атомарной заменой
+    // указателя, запросы читают ее без отдельной блокировки. замененная
+    // политика освобождается, как только ее никто не читает. max_sessions
+    // выше начального не действует - таблицы сегментов выделены заранее
+    void set_policy(std::unique_ptr<const Policy> policy);
+    // снимок текущей политики: остается действительным и после set_policy(),
+    // но по смыслу его держат не дольше одного запроса
+    std::shared_ptr<const Policy> policy() const;
     
     enum class CreateResult {
         CREATED,
@@ -24,25 +50,78 @@ public:
         ALREADY_EXISTS
     };
     
-    CreateResult try_create_session(const std::string& imsi);
-    bool is_active(const std::string& imsi) const;
-    void remove_session(const std::string& imsi);
+    // таймаут считается от последней активности: повторный запрос
+    // на существующую сессию продлевает ее так же, как refresh_session
+    CreateResult try_create_session(Imsi imsi);
+    bool refresh_session(Imsi imsi);  // false - сессии нет
+    bool is_active(Imsi imsi) const;
+    // время последней активности по списку IMSI (nullopt - сессии нет),
+    // в порядке входного списка. IMSI группируются по сегментам, каждый
+    // сегмент блокируется один раз на весь список
+    std::vector<std::optional<std::chrono::steady_clock::time_point>>
+    last_seen_batch(const std::vector<Imsi>& imsis) const;
+    std::chrono::seconds session_timeout() const { return policy()->session_timeout; }
+    bool remove_session(Imsi imsi);  // false - сессии не было
+    // удаляем истекшие сессии; стоимость пропорциональна числу истекших,
+    // а не размеру таблицы. вариант с логгером пишет CDR "expired"
     void remove_expired_sessions();
+    void remove_expired_sessions(CDRLogger& cdr_logger);
+    // когда истечет ближайшая сессия при текущем таймауте (nullopt - сессий нет);
+    // новые сессии истекают позже уже существующих
+    std::optional<std::chrono::steady_clock::time_point> next_expiry() const;
     unsigned active_sessions() const;
-    void graceful_shutdown(unsigned rate, CDRLogger& cdr_logger);
+    
+    // graceful shutdown: пока прием закрыт, новые сессии отклоняются
+    // как REJECTED_LIMIT, существующие продлеваются и удаляются как обычно
+    void set_accepting(bool accepting);
+    bool accepting() const { return accepting_.load(std::memory_order_relaxed); }
+    // удаляем до max_count самых старых сессий с CDR "graceful_remove":
+    // сегменты обходятся по кругу, в каждом пачка снимается за одну
+    // блокировку. возвращаем число удаленных
+    size_t drain_batch(size_t max_count, CDRLogger& cdr_logger);
+    
+    // сохранение состояния: изменения сессий пишутся в журнал хранилища
+    // (nullptr - отключить). подключается до приема запросов
+    void attach_store(SessionStore* store);
+    // восстановление из снимка: вставка с заданным временем активности,
+    // без журнала и CDR. сессии вставляются от давних к свежим
+    bool restore_session(Imsi imsi, std::chrono::steady_clock::time_point last_seen);
+    // копия сегмента под его блокировкой для снимка
+    size_t shards() const { return shard_mask_ + 1; }
+    void copy_shard(size_t index,
+                    std::vector<std::pair<Imsi, std::chrono::steady_clock::time_point>>& out) const;
 
 private:
-    struct Session {
-        std::chrono::steady_clock::time_point created_at;
+    // сегмент таблицы сессий со своей блокировкой,
+    // выровнен по кэш-линии, чтобы соседние мьютексы не делили ее.
+    // таблица заранее рассчитана на свою долю max_sessions
+    struct alignas(64) Shard {
+        mutable std::mutex mutex;
+        SessionTable table;
     };
 
-    void graceful_remove(const std::string& imsi, CDRLogger& cdr_logger);
+    size_t shard_index(Imsi imsi) const;
+    Shard& shard_for(Imsi imsi);
+    const Shard& shard_for(Imsi imsi) const;
+    // занимаем место в глобальном лимите max_sessions политики
+    bool reserve_slot(const Policy& policy);
+    void expire_sessions(CDRLogger* cdr_logger);
+    
+    // политика для горячего пути - читать только под блокировкой сегмента:
+    // set_policy() после замены проходит блокировки всех сегментов, и после
+    // этого старый указатель уже никто не держит
+    const Policy& locked_policy() const { return *policy_.load(std::memory_order_acquire); }
     
-    mutable std::mutex mutex_;
-    std::unordered_map<std::string, Session> sessions_;
-    const std::set<std::string>& blacklist_;
-    const std::chrono::seconds session_timeout_;
-    const unsigned max_sessions_;
+    std::shared_ptr<const Policy> policy_owner_;  // под policy_mutex_
+    std::atomic<const Policy*> policy_;
+    const unsigned table_limit_;  // max_sessions, на который выделены таблицы
+    mutable std::mutex policy_mutex_;
+    const size_t shard_mask_;
+    std::unique_ptr<Shard[]> shards_;
+    std::atomic<unsigned> session_count_{0};
+    std::atomic<SessionStore*> store_{nullptr};
+    std::atomic<bool> accepting_{true};
+    size_t drain_cursor_ = 0;  // сегмент, с которого начнется следующая пачка
 };
 
-} // namespace pgw
\ No newline at end of file
+} // namespace pgw
@@ -0,0 +1,121 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+#include "Imsi.hpp"
+#include "MpscRing.hpp"
+
+namespace pgw {
+
+class SessionManager;
+
+struct SessionStoreOptions {
+    std::string dir;                     // каталог снимка и журналов
+    unsigned snapshot_interval_sec = 60; // период снимков (0 - только при остановке)
+    size_t queue_size = 65536;           // записей журнала в кольцевом буфере
+    unsigned flush_interval_ms = 200;    // максимальная задержка записи журнала
+    bool fsync = false;                  // fdatasync журнала после каждой пачки
+};
+
+// сохранение таблицы сессий между перезапусками: периодический снимок
+// плюс журнал изменений с момента снимка.
+//
+// каталог:
+//   sessions.snap   - kSnapshotMagic, поколение (8), число записей (8),
+//                     записи по 16 байт: IMSI (Imsi::raw) и время последней
+//                     активности в мс от эпохи Unix
+//   journal.<N>     - kJournalMagic, записи по 16 байт: IMSI (8),
+//                     время в мс (6), операция (1), резерв (1)
+// все числа little-endian. снимок поколения N содержит состояние на момент
+// начала journal.<N>; восстановление - снимок плюс журналы от N и дальше.
+// операции журнала абсолютные (установить время / удалить), поэтому
+// записи, попавшие и в снимок, и в журнал, применяются повторно без вреда
+class SessionStore {
+public:
+    static constexpr std::string_view kSnapshotMagic{"PGWSNAP\x01", 8};
+    static constexpr std::string_view kJournalMagic{"PGWJRNL\x01", 8};
+    static constexpr size_t kRecordSize = 16;
+
+    enum class Op : uint8_t {
+        UPSERT = 1,  // создание или продление
+        REMOVE = 2
+    };
+
+    SessionStore(SessionManager& session_manager, const SessionStoreOptions& options);
+    ~SessionStore();
+
+    SessionStore(const SessionStore&) = delete;
+    SessionStore& operator=(const SessionStore&) = delete;
+
+    // загружаем снимок и журналы в менеджер сессий, возвращаем число
+    // восстановленных сессий. вызывается до start() и до приема запросов;
+    // сессии, простоявшие дольше таймаута, пропускаются
+    size_t recover(std::chrono::seconds session_timeout);
+
+    // делаем снимок с новым журналом, подключаемся к менеджеру сессий и
+    // запускаем потоки записи журнала и периодических снимков
+    void start();
+    // останавливаем потоки, дописываем журнал и делаем финальный снимок
+    void stop();
+
+    // горячий путь: вызывается SessionManager под блокировкой сегмента,
+    // поэтому порядок записей одного IMSI совпадает с порядком изменений.
+    // при переполнении очереди UPSERT теряется до следующего снимка, а
+    // REMOVE ждет места: потерянное удаление вернуло бы сессию после
+    // перезапуска. поток журнала снимками не занят, ожидание короткое
+    void record(Op op, Imsi imsi);
+
+    // снимок прямо сейчас (из любого потока); false - ошибка записи.
+    // журнал в это время продолжает писаться в новое поколение
+    bool snapshot();
+
+    uint64_t generation() const { return generation_.load(std::memory_order_relaxed); }
+    uint64_t journaled() const { return journaled_.load(std::memory_order_relaxed); }
+    uint64_t dropped() const { return dropped_.load(std::memory_order_relaxed); }
+
+private:
+    struct Entry {
+        uint64_t imsi;
+        int64_t time_ms;
+        Op op;
+    };
+
+    std::string snapshot_path() const;
+    std::string journal_path(uint64_t generation) const;
+    std::vector<uint64_t> journal_generations() const;  // по возрастанию
+
+    void writer_loop();
+    void snapshot_loop();
+    // под journal_mutex_: забираем очередь в журнал
+    void drain_locked();
+    void open_journal_locked(uint64_t generation);
+    // под snapshot_mutex_, без journal_mutex_
+    bool write_snapshot(uint64_t generation);
+
+    SessionManager& session_manager_;
+    const SessionStoreOptions options_;
+    MpscRing<Entry> queue_;
+
+    std::mutex snapshot_mutex_;  // снимки по одному
+    std::mutex journal_mutex_;   // файл журнала и смена поколения
+    int journal_fd_ = -1;
+    std::string buffer_;
+    std::atomic<uint64_t> generation_{0};
+
+    std::atomic<uint64_t> journaled_{0};
+    std::atomic<uint64_t> dropped_{0};
+    std::atomic<bool> running_{false};
+    std::mutex wake_mutex_;
+    std::condition_variable wake_cv_;      // будим поток журнала
+    std::condition_variable snapshot_cv_;  // будим поток снимков при остановке
+    std::thread writer_;
+    std::thread snapshotter_;
+};
+
+} // namespace pgw
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <vector>
+#include "Imsi.hpp"
+
+namespace pgw {
+
+// плоская хеш-таблица сессий с открытой адресацией (Robin Hood).
+// вся память выделяется в конструкторе, вставка и удаление не аллоцируют.
+// удаление - обратным сдвигом, без надгробий, поэтому цепочки не деградируют.
+// записи дополнительно связаны в двусвязный список по индексам слотов
+// в порядке последней активности (вставка или touch): при одинаковом
+// таймауте простоя это порядок истечения
+class SessionTable {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    SessionTable() = default;
+    explicit SessionTable(size_t capacity);  // округляется до степени двойки
+
+    size_t size() const { return size_; }
+    size_t capacity() const { return slots_.size(); }
+
+    bool contains(Imsi imsi) const { return find(imsi) != kNil; }
+    // время последней активности, nullopt - записи нет
+    std::optional<Clock::time_point> last_seen(Imsi imsi) const {
+        const uint32_t index = find(imsi);
+        if (index == kNil) return std::nullopt;
+        return time_of(slots_[index]);
+    }
+    // false, если запись уже есть или таблица заполнена
+    bool insert(Imsi imsi, Clock::time_point last_seen);
+    bool erase(Imsi imsi);
+    // обновляем время активности и переносим запись в хвост списка;
+    // now не должно быть раньше времени остальных записей
+    bool touch(Imsi imsi, Clock::time_point now);
+
+    // голова списка истечения: запись, дольше всех не проявлявшая активности
+    bool empty() const { return head_ == kNil; }
+    Imsi front() const { return Imsi::from_raw(slots_[head_].key); }
+    Clock::time_point front_last_seen() const { return time_of(slots_[head_]); }
+    void pop_front() { erase_at(head_); }
+
+    // обход от старых записей к новым: bool f(Imsi, Clock::time_point),
+    // false из f прекращает обход
+    template <typename F>
+    void for_each(F&& f) const {
+        for (uint32_t i = head_; i != kNil; i = slots_[i].next) {
+            if (!f(Imsi::from_raw(slots_[i].key), time_of(slots_[i]))) break;
+        }
+    }
+
+private:
+    static constexpr uint32_t kNil = UINT32_MAX;
+
+    struct Slot {
+        uint64_t key = 0;        // Imsi::raw(), 0 - свободный слот
+        int64_t last_seen = 0;   // тики steady_clock
+        uint32_t prev = kNil;    // соседи в списке истечения
+        uint32_t next = kNil;
+    };
+
+    static Clock::time_point time_of(const Slot& slot) {
+        return Clock::time_point(Clock::duration(slot.last_seen));
+    }
+
+    size_t home(uint64_t key) const;                    // идеальная позиция ключа
+    size_t distance(size_t index, uint64_t key) const;  // отступ от идеальной позиции
+    uint32_t find(Imsi imsi) const;
+    void move_slot(size_t from, size_t to);             // перенос с исправлением ссылок списка
+    void erase_at(uint32_t index);
+    void unlink(uint32_t index);                        // исключаем из списка истечения
+    void link_back(uint32_t index);                     // добавляем в хвост списка
+
+    std::vector<Slot> slots_;
+    size_t mask_ = 0;
+    size_t size_ = 0;
+    uint32_t head_ = kNil;
+    uint32_t tail_ = kNil;
+};
+
+} // namespace pgw
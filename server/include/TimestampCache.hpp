@@ -0,0 +1,30 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+namespace pgw {
+
+// кеш отформатированного времени "YYYY-MM-DD HH:MM:SS[.mmm]" в локальной зоне.
+// localtime_r/strftime вызываются только при смене секунды, миллисекунды
+// дописываются тремя цифрами поверх готовой строки.
+// не потокобезопасен: у каждого потока-писателя свой экземпляр
+class TimestampCache {
+public:
+    explicit TimestampCache(bool with_millis = false) : with_millis_(with_millis) {}
+
+    // строка действительна до следующего вызова format()
+    std::string_view format(int64_t timestamp_ns);
+
+    // дешевое текущее время для горячего пути (CLOCK_REALTIME_COARSE, точность ~1-4 мс)
+    static int64_t coarse_now_ns();
+
+private:
+    static constexpr size_t kSecondsLength = 19;  // "YYYY-MM-DD HH:MM:SS"
+
+    const bool with_millis_;
+    int64_t cached_second_ = INT64_MIN;
+    char text_[kSecondsLength + 5] = {};  // + ".mmm" и запас под '\0' от strftime
+};
+
+} // namespace pgw
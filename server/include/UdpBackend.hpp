@@ -0,0 +1,12 @@
+#pragma once
+
+namespace pgw {
+
+// способ приема и отправки датаграмм
+enum class UdpBackend {
+    EPOLL,     // recvfrom/sendto или recvmmsg/sendmmsg по готовности сокета
+    IO_URING   // многоразовый recvmsg с кольцом буферов и пачки отправок;
+               // только в сборке с PGW_WITH_IO_URING, иначе - EPOLL
+};
+
+} // namespace pgw
@@ -1,30 +1,81 @@
 #pragma once
 #include <netinet/in.h>
 #include <atomic>
+#include <memory>
+#include <optional>
 #include <string>
+#include <string_view>
 #include "SessionManager.hpp"
 #include "CDRLogger.hpp"
+#include "Protocol.hpp"
+#include "GtpTeidMap.hpp"
+#include "Reactor.hpp"
+#include "UdpBackend.hpp"
 
 namespace pgw {
 
 class UdpServer {
 public:
-    UdpServer(const std::string& ip, uint16_t port, 
+    // batch_size > 1 включает пакетный режим (recvmmsg/sendmmsg),
+    // reuse_port - SO_REUSEPORT для нескольких воркеров на одном порту.
+    // teids - общая для воркеров таблица TEID GTPv2-C; без нее сервер
+    // заводит свою. batch_size относится только к EPOLL
+    UdpServer(const std::string& ip, uint16_t port,
               SessionManager& session_manager,
-              CDRLogger& cdr_logger);
-    
+              CDRLogger& cdr_logger,
+              unsigned batch_size = 1,
+              bool reuse_port = false,
+              GtpTeidMap* teids = nullptr,
+              UdpBackend backend = UdpBackend::EPOLL);
+
+    // цикл событий воркера: сокет неблокирующий, поток спит в epoll_wait,
+    // stop() будит его через eventfd из любого потока
     void run();
     void stop();
     uint16_t port() const;  // метод для получения порта
-    
+    // способ приема, которым на деле работает run(): IO_URING только если
+    // кольцо удалось создать, иначе EPOLL. nullopt - run() еще не запущен
+    std::optional<UdpBackend> active_backend() const;
+
 private:
-    void handle_request(const std::string& imsi, const sockaddr_in& client_addr);
+    struct BatchBuffers;  // буферы recvmmsg/sendmmsg пакетного режима
+#ifdef PGW_WITH_IO_URING
+    struct UringState;    // кольцо io_uring, буферы приема и слоты отправки
+    // false - io_uring недоступен (ядро, seccomp), нужен обычный цикл
+    bool run_uring();
+#endif
     
+    // забираем все, что пришло на сокет (с ограничением на один вызов,
+    // чтобы stop() не ждал под непрерывной нагрузкой)
+    void set_active_backend(UdpBackend backend);
+    void receive_datagrams();
+    void receive_batches(BatchBuffers& batch);
+    void handle_request(std::string_view payload, const sockaddr_in& client_addr);
+    // журнал и разбор запроса, общие для всех способов приема
+    std::string_view serve(std::string_view payload, const sockaddr_in& client_addr, char* reply);
+    // разбираем запрос (текстовый или бинарный) и возвращаем ответ клиенту;
+    // бинарный ответ собирается в reply размером не меньше kMaxResponseSize.
+    // пустой ответ - пакет отброшен, отвечать не нужно
+    std::string_view process_request(std::string_view payload, char* reply);
+    std::string_view process_binary(std::string_view payload, char* reply);
+    std::string_view process_gtp(std::string_view payload, char* reply);
+    // операции над сессией с записью CDR и метрик
+    ResultCode create_session(Imsi imsi);
+    ResultCode delete_session(Imsi imsi);   // DELETED или NOT_FOUND
+    ResultCode refresh_session(Imsi imsi);  // REFRESHED или NOT_FOUND
+    ResultCode apply(PacketType request, Imsi imsi);
+
     int sockfd_;
     sockaddr_in addr_;
-    std::atomic<bool> running_{false};
+    Reactor reactor_;  // остановка в stop() действует и до run()
     SessionManager& session_manager_;
     CDRLogger& cdr_logger_;
+    const unsigned batch_size_;
+    const UdpBackend backend_;
+    UdpBackend active_backend_ = UdpBackend::EPOLL;  // публикуется через started_
+    std::atomic<bool> started_{false};
+    std::unique_ptr<GtpTeidMap> own_teids_;
+    GtpTeidMap* teids_;
 };
 
-} // namespace pgw
\ No newline at end of file
+} // namespace pgw
@@ -0,0 +1,38 @@
+#pragma once
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include "UdpServer.hpp"
+
+namespace pgw {
+
+// пул UDP воркеров: каждый со своим SO_REUSEPORT сокетом на общем ip:port
+// и своим потоком, менеджер сессий, CDR логгер и таблица TEID общие
+class UdpWorkerPool {
+public:
+    // teids == nullptr - пул заводит свою таблицу TEID
+    UdpWorkerPool(const std::string& ip, uint16_t port,
+                  unsigned workers,
+                  SessionManager& session_manager,
+                  CDRLogger& cdr_logger,
+                  unsigned batch_size = 1,
+                  std::vector<int> cpu_affinity = {},
+                  GtpTeidMap* teids = nullptr,
+                  UdpBackend backend = UdpBackend::EPOLL);
+    
+    ~UdpWorkerPool();
+    
+    void start();  // запускаем потоки воркеров
+    void stop();   // останавливаем всех воркеров и ждем их завершения
+    uint16_t port() const;
+    unsigned size() const;
+
+private:
+    std::unique_ptr<GtpTeidMap> own_teids_;
+    std::vector<std::unique_ptr<UdpServer>> workers_;
+    std::vector<std::thread> threads_;
+    std::vector<int> cpu_affinity_;  // воркер i -> cpu_affinity_[i % size]
+};
+
+} // namespace pgw
@@ -0,0 +1,249 @@
+#include "Blacklist.hpp"
+#include "MappedFile.hpp"
+#include <spdlog/spdlog.h>
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <stdexcept>
+#include <thread>
+
+namespace pgw {
+
+namespace {
+
+constexpr size_t kFilterBitsPerKey = 12;     // ~0.5% ложных срабатываний
+constexpr size_t kFilterBitsPerBlock = 512;
+constexpr uint64_t kPrefixSeed = 0x5bd1e9955bd1e995ull;  // разные хеши у IMSI и префикса
+constexpr size_t kMinChunkSize = 1 << 20;    // меньшие куски не окупают поток
+
+uint64_t mix(uint64_t x) {
+    // finalizer из splitmix64
+    x ^= x >> 30;
+    x *= 0xbf58476d1ce4e5b9ull;
+    x ^= x >> 27;
+    x *= 0x94d049bb133111ebull;
+    x ^= x >> 31;
+    return x;
+}
+
+// первые length цифр IMSI в виде упакованного префикса
+uint64_t truncate(uint64_t raw, unsigned length) {
+    return (raw & ~((uint64_t(1) << (64 - 4 * length)) - 1)) | length;
+}
+
+// первые digits цифр упакованного значения числом
+uint32_t head_of(uint64_t raw, unsigned digits) {
+    uint32_t head = 0;
+    for (unsigned i = 0; i < digits; ++i) {
+        head = head * 10 + ((raw >> (60 - 4 * i)) & 0xF);
+    }
+    return head;
+}
+
+std::string_view trim(std::string_view text) {
+    while (!text.empty() && (text.front() == ' ' || text.front() == '\t')) text.remove_prefix(1);
+    while (!text.empty() && (text.back() == ' ' || text.back() == '\t' || text.back() == '\r')) {
+        text.remove_suffix(1);
+    }
+    return text;
+}
+
+} // namespace
+
+bool Blacklist::parse_entry(std::string_view entry, Entries& out) {
+    entry = trim(entry);
+    if (entry.empty()) return false;
+    
+    if (entry.back() == '*') {
+        auto prefix = Imsi::parse(entry.substr(0, entry.size() - 1));
+        if (!prefix) return false;
+        out.prefixes.push_back(prefix->raw());
+        out.prefix_lengths |= uint16_t(1u << prefix->length());
+        return true;
+    }
+    
+    const size_t dash = entry.find('-');
+    if (dash != std::string_view::npos) {
+        auto first = Imsi::parse(trim(entry.substr(0, dash)));
+        auto last = Imsi::parse(trim(entry.substr(dash + 1)));
+        if (!first || !last || *last < *first) return false;
+        out.ranges.emplace_back(first->raw(), last->raw());
+        return true;
+    }
+    
+    auto imsi = Imsi::parse(entry);
+    if (!imsi) return false;
+    out.exact.push_back(imsi->raw());
+    return true;
+}
+
+size_t Blacklist::parse_chunk(std::string_view text, Entries& out) {
+    size_t invalid = 0;
+    for (size_t pos = 0; pos < text.size(); ) {
+        size_t end = text.find('\n', pos);
+        if (end == std::string_view::npos) end = text.size();
+        const std::string_view line = trim(text.substr(pos, end - pos));
+        if (!line.empty() && line.front() != '#' && !parse_entry(line, out)) invalid++;
+        pos = end + 1;
+    }
+    return invalid;
+}
+
+void Blacklist::merge(Entries&& part) {
+    exact_.insert(exact_.end(), part.exact.begin(), part.exact.end());
+    prefixes_.insert(prefixes_.end(), part.prefixes.begin(), part.prefixes.end());
+    ranges_.insert(ranges_.end(), part.ranges.begin(), part.ranges.end());
+    prefix_lengths_ |= part.prefix_lengths;
+}
+
+void Blacklist::add(std::string_view entry) {
+    Entries part;
+    if (!parse_entry(entry, part)) {
+        throw std::invalid_argument("неверная запись черного списка: " + std::string(entry));
+    }
+    merge(std::move(part));
+}
+
+size_t Blacklist::load_file(const std::string& path, unsigned threads) {
+    const auto started = std::chrono::steady_clock::now();
+    MappedFile file(path);
+    if (!file.is_open()) {
+        throw std::runtime_error("Не удалось открыть черный список " + path + ": " + strerror(file.error()));
+    }
+    const std::string_view text = file.view();
+    
+    if (threads == 0) threads = std::max(1u, std::thread::hardware_concurrency());
+    threads = static_cast<unsigned>(std::min<size_t>(threads, text.size() / kMinChunkSize + 1));
+    
+    // режем файл на куски по границам строк, каждый кусок - в своем потоке
+    std::vector<Entries> parts(threads);
+    std::vector<size_t> invalid(threads, 0);
+    std::vector<std::thread> workers;
+    size_t begin = 0;
+    for (unsigned i = 0; i < threads; ++i) {
+        size_t end = text.size();
+        if (i + 1 < threads) {
+            end = text.find('\n', std::max(begin, text.size() * (i + 1) / threads));
+            end = end == std::string_view::npos ? text.size() : end + 1;
+        }
+        const std::string_view chunk = text.substr(begin, end - begin);
+        workers.emplace_back([chunk, &part = parts[i], &bad = invalid[i]] {
+            bad = parse_chunk(chunk, part);
+        });
+        begin = end;
+    }
+    for (auto& worker : workers) worker.join();
+    
+    size_t loaded = 0;
+    size_t skipped = 0;
+    for (unsigned i = 0; i < threads; ++i) {
+        loaded += parts[i].exact.size() + parts[i].prefixes.size() + parts[i].ranges.size();
+        skipped += invalid[i];
+        merge(std::move(parts[i]));
+    }
+    
+    const auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - started);
+    spdlog::info("Черный список {}: {} записей за {} мс ({} потоков)", path, loaded, elapsed.count(), threads);
+    if (skipped > 0) {
+        spdlog::warn("Черный список {}: пропущено {} некорректных строк", path, skipped);
+    }
+    return loaded;
+}
+
+void Blacklist::build() {
+    std::sort(exact_.begin(), exact_.end());
+    exact_.erase(std::unique(exact_.begin(), exact_.end()), exact_.end());
+    std::sort(prefixes_.begin(), prefixes_.end());
+    prefixes_.erase(std::unique(prefixes_.begin(), prefixes_.end()), prefixes_.end());
+    
+    // сливаем пересекающиеся диапазоны, чтобы поиск был одним upper_bound
+    std::sort(ranges_.begin(), ranges_.end());
+    std::vector<std::pair<uint64_t, uint64_t>> merged;
+    for (const auto& range : ranges_) {
+        if (!merged.empty() && range.first <= merged.back().second) {
+            merged.back().second = std::max(merged.back().second, range.second);
+        } else {
+            merged.push_back(range);
+        }
+    }
+    ranges_ = std::move(merged);
+    
+    // короткий префикс покрывает все головы, которые он начинает
+    prefix_heads_.assign((kHeadCount + 63) / 64, 0);
+    for (uint64_t raw : prefixes_) {
+        const unsigned length = raw & 0xF;
+        const unsigned known = std::min(length, kHeadDigits);
+        uint32_t span = 1;
+        for (unsigned i = known; i < kHeadDigits; ++i) span *= 10;
+        const uint32_t first = head_of(raw, known) * span;
+        for (uint32_t head = first; head < first + span; ++head) {
+            prefix_heads_[head / 64] |= uint64_t(1) << (head % 64);
+        }
+    }
+    
+    const size_t keys = exact_.size() + prefixes_.size();
+    filter_.clear();
+    filter_mask_ = 0;
+    if (keys == 0) return;
+    
+    size_t blocks = 1;
+    while (blocks * kFilterBitsPerBlock < keys * kFilterBitsPerKey) blocks <<= 1;
+    filter_.assign(blocks, FilterBlock{});
+    filter_mask_ = blocks - 1;
+    for (uint64_t raw : exact_) filter_add(mix(raw));
+    for (uint64_t raw : prefixes_) filter_add(mix(raw ^ kPrefixSeed));
+}
+
+// по одному биту ключа в каждом из 8 слов блока (split block Bloom filter):
+// проверка без ветвлений, компилятор разворачивает цикл
+void Blacklist::filter_add(uint64_t hash) {
+    FilterBlock& block = filter_[(hash >> 32) & filter_mask_];
+    const uint64_t bits = hash * 0x9e3779b97f4a7c15ull;
+    for (unsigned i = 0; i < 8; ++i) {
+        block.words[i] |= uint64_t(1) << ((bits >> (16 + 6 * i)) & 63);
+    }
+}
+
+bool Blacklist::filter_may_contain(uint64_t hash) const {
+    const FilterBlock& block = filter_[(hash >> 32) & filter_mask_];
+    const uint64_t bits = hash * 0x9e3779b97f4a7c15ull;
+    uint64_t found = 1;
+    for (unsigned i = 0; i < 8; ++i) {
+        found &= block.words[i] >> ((bits >> (16 + 6 * i)) & 63);
+    }
+    return found != 0;
+}
+
+bool Blacklist::contains(Imsi imsi) const {
+    const uint64_t raw = imsi.raw();
+    
+    if (!filter_.empty()) {
+        if (filter_may_contain(mix(raw)) && std::binary_search(exact_.begin(), exact_.end(), raw)) {
+            return true;
+        }
+        // префиксы проверяем только тех длин, что есть в списке,
+        // и только если с первых цифр IMSI начинается хоть один префикс
+        unsigned lengths = prefix_lengths_ & ((2u << imsi.length()) - 1);
+        if (lengths != 0 && imsi.length() >= kHeadDigits) {
+            const uint32_t head = head_of(raw, kHeadDigits);
+            if (!(prefix_heads_[head / 64] & (uint64_t(1) << (head % 64)))) lengths = 0;
+        }
+        for (; lengths != 0; lengths &= lengths - 1) {
+            const uint64_t key = truncate(raw, __builtin_ctz(lengths));
+            if (filter_may_contain(mix(key ^ kPrefixSeed)) &&
+                std::binary_search(prefixes_.begin(), prefixes_.end(), key)) {
+                return true;
+            }
+        }
+    }
+    
+    if (!ranges_.empty()) {
+        auto it = std::upper_bound(ranges_.begin(), ranges_.end(), raw,
+            [](uint64_t value, const std::pair<uint64_t, uint64_t>& range) { return value < range.first; });
+        if (it != ranges_.begin() && raw <= std::prev(it)->second) return true;
+    }
+    return false;
+}
+
+} // namespace pgw
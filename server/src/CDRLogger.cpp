@@ -1,38 +1,234 @@
 #include "CDRLogger.hpp"
+#include <spdlog/spdlog.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstring>
 #include <ctime>
-#include <iomanip>
-#include <sstream>
+#include <stdexcept>
 
 namespace pgw {
 
-CDRLogger::CDRLogger(const std::string& filename) {
+namespace {
+constexpr size_t kBatchBytes = 64 * 1024;  // размер пачки для одного write()
+}
+
+CDRLogger::CDRLogger(const std::string& filename, const CdrOptions& options)
+    : filename_(filename),
+      options_(options),
+      timestamps_(options.timestamp_millis),
+      queue_(options.queue_size) {
+    open_file();
+    writer_ = std::thread(&CDRLogger::writer_loop, this);
+}
+
+void CDRLogger::open_file() {
     // открываем файл в режиме добавления (append)
-    file_.open(filename, std::ios::app);
-    if (!file_.is_open()) {
-        throw std::runtime_error("Не удалось открыть CDR файл: " + filename);
+    fd_ = ::open(filename_.c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+    if (fd_ < 0) {
+        throw std::runtime_error("Не удалось открыть CDR файл: " + filename_);
+    }
+    struct stat st{};
+    fstat(fd_, &st);
+    file_bytes_ = st.st_size;
+    file_records_ = 0;
+    file_opened_at_ = std::chrono::steady_clock::now();
+    
+    // записываем заголовок при первом открытии; если не вышло, повторим перед пачкой
+    write_header();
+}
+
+bool CDRLogger::write_header() {
+    if (file_bytes_ > 0) return true;
+    return write_out(options_.format == CdrFormat::BINARY ? kCdrBinaryMagic : kCdrCsvHeader);
+}
+
+bool CDRLogger::rotation_due(size_t incoming_bytes) const {
+    if (file_records_ == 0) return false;  // пустые файлы не плодим
+    if (options_.rotate_bytes > 0 && file_bytes_ + incoming_bytes > options_.rotate_bytes) {
+        return true;
+    }
+    return options_.rotate_interval_sec > 0 &&
+           std::chrono::steady_clock::now() - file_opened_at_ >=
+               std::chrono::seconds(options_.rotate_interval_sec);
+}
+
+void CDRLogger::rotate() {
+    // имя архива: <файл>.YYYYMMDD-HHMMSS[-N]
+    const std::time_t now = std::time(nullptr);
+    std::tm local{};
+    localtime_r(&now, &local);
+    char suffix[32];
+    std::strftime(suffix, sizeof(suffix), ".%Y%m%d-%H%M%S", &local);
+    
+    std::string rotated = filename_ + suffix;
+    for (unsigned n = 1; ::access(rotated.c_str(), F_OK) == 0; ++n) {
+        rotated = filename_ + suffix + "-" + std::to_string(n);
+    }
+    
+    // rename атомарен: сборщик видит либо старый файл целиком, либо архив
+    if (::rename(filename_.c_str(), rotated.c_str()) != 0) {
+        spdlog::error("Не удалось ротировать CDR файл {}: {}", filename_, strerror(errno));
+        file_opened_at_ = std::chrono::steady_clock::now();  // повторим через интервал
+        return;
+    }
+    ::close(fd_);
+    try {
+        open_file();
+    } catch (const std::exception& e) {
+        // продолжаем работу: записи будут теряться с ошибкой в логе
+        spdlog::critical("{}", e.what());
+        return;
     }
-    // записываем заголовок при первом открытии
-    if (file_.tellp() = 0) file_ << "timestamp,imsi,action\n";
+    rotations_.fetch_add(1, std::memory_order_relaxed);
+    spdlog::info("CDR файл ротирован: {}", rotated);
 }
 
-std::string CDRLogger::current_time() const {
-    // получаем текущее системное время
-    auto now = std::chrono::system_clock::now();
-    auto in_time_t = std::chrono::system_clock::to_time_t(now);
+CDRLogger::~CDRLogger() {
+    // поток записи дописывает все, что осталось в очереди
+    running_ = false;
+    wake_cv_.notify_one();
+    if (writer_.joinable()) {
+        writer_.join();
+    }
+    ::close(fd_);
+}
+
+void CDRLogger::log(Imsi imsi, CdrAction action) {
+    // грубые часы без syscall: форматирование времени целиком в потоке записи
+    const CdrRecord record{
+        TimestampCache::coarse_now_ns(),
+        imsi.raw(),
+        action
+    };
+    
+    while (!queue_.try_push(record)) {
+        if (!options_.block_when_full) {
+            dropped_.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        // режим обратного давления: ждем, пока поток записи освободит место
+        wake_cv_.notify_one();
+        std::this_thread::yield();
+    }
     
-    // форматируем время в читаемый вид
-    std::stringstream ss;
-    ss << std::put_time(std::localtime(&in_time_t), "%Y-%m-%d %H:%M:%S");
-    return ss.str();
+    // будим поток записи заранее, если очередь заполнена наполовину
+    if (queue_.size() > queue_.capacity() / 2) {
+        wake_cv_.notify_one();
+    }
+}
+
+void CDRLogger::flush() {
+    const uint64_t target = queue_.pushed();
+    std::unique_lock lock(wake_mutex_);
+    while (written() + lost_.load(std::memory_order_relaxed) < target) {
+        flush_requested_ = true;
+        wake_cv_.notify_one();
+        flushed_cv_.wait(lock);
+    }
 }
 
-void CDRLogger::log(const std::string& imsi, const std::string& action) {
-    std::lock_guard lock(mutex_);  // защищаем запись от конкурентного доступа
+size_t CDRLogger::drain(std::string& buffer) {
+    size_t count = 0;
+    CdrRecord record;
     
-    // форматируем строку лога: время, IMSI, действие
-    file_ << current_time() << "," << imsi << "," << action << "\n";
-    file_.flush();  // сразу пишем на диск
+    // форматируем записи: строка CSV или 16 байт бинарного формата
+    while (buffer.size() < kBatchBytes && queue_.try_pop(record)) {
+        if (options_.format == CdrFormat::BINARY) {
+            append_binary(buffer, record);
+        } else {
+            append_csv(buffer, record, timestamps_);
+        }
+        count++;
+    }
+    return count;
+}
+
+bool CDRLogger::write_out(std::string_view buffer) {
+    size_t offset = 0;
+    while (offset < buffer.size()) {
+        ssize_t n = ::write(fd_, buffer.data() + offset, buffer.size() - offset);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            spdlog::error("Ошибка записи CDR: {}", strerror(errno));
+            // отрезаем недописанный хвост пачки: иначе бинарный файл
+            // теряет выравнивание записей, а CSV - целостность строк
+            if (offset > 0 && ::ftruncate(fd_, file_bytes_) != 0) {
+                spdlog::error("Не удалось обрезать CDR файл {}: {}", filename_, strerror(errno));
+            }
+            return false;
+        }
+        offset += n;
+    }
+    file_bytes_ += buffer.size();
+    if (options_.fsync) {
+        fdatasync(fd_);
+    }
+    return true;
+}
 
+void CDRLogger::writer_loop() {
+    const auto flush_interval = std::chrono::milliseconds(options_.flush_interval_ms);
+    std::string buffer;
+    buffer.reserve(kBatchBytes + 256);
+    size_t pending = 0;  // записей в буфере, еще не отданных в файл
+    uint64_t reported_drops = 0;
+    auto last_write = std::chrono::steady_clock::now();
+    
+    for (;;) {
+        const bool stopping = !running_;
+        pending += drain(buffer);
+        
+        // пишем большими пачками: по заполнению буфера, по интервалу или по запросу
+        const auto now = std::chrono::steady_clock::now();
+        if (pending > 0 && (buffer.size() >= kBatchBytes || now - last_write >= flush_interval ||
+                            flush_requested_ || stopping)) {
+            if (rotation_due(buffer.size())) rotate();
+            if (write_header() && write_out(buffer)) {
+                file_records_ += pending;
+                written_.fetch_add(pending, std::memory_order_relaxed);
+            } else if (stopping) {
+                // повторять больше некогда: записи теряются, но учитываются
+                spdlog::critical("CDR не записаны при остановке, потеряно записей: {}", pending);
+                lost_.fetch_add(pending, std::memory_order_relaxed);
+            } else {
+                // диск не принял пачку (ENOSPC, EIO): буфер сохраняем и повторяем
+                // через интервал сброса; очередь тем временем копится
+                std::unique_lock lock(wake_mutex_);
+                wake_cv_.wait_for(lock, flush_interval, [this] { return !running_; });
+                continue;
+            }
+            buffer.clear();
+            pending = 0;
+            last_write = now;
+        }
+        
+        // буфер пуст - будим ожидающих flush(), каждый сверит свою цель
+        if (flush_requested_ && pending == 0) {
+            {
+                std::lock_guard lock(wake_mutex_);
+                flush_requested_ = false;
+            }
+            flushed_cv_.notify_all();
+        }
+        
+        const uint64_t drops = dropped_.load(std::memory_order_relaxed);
+        if (drops != reported_drops) {
+            spdlog::warn("Очередь CDR переполнена, отброшено записей: {}", drops - reported_drops);
+            reported_drops = drops;
+        }
+        
+        if (stopping && queue_.size() == 0 && pending == 0) break;
+        if (pending == 0 && rotation_due(0)) rotate();  // ротация по времени без трафика
+        if (queue_.size() > 0 || buffer.size() >= kBatchBytes) continue;
+        
+        // очередь пуста: спим до интервала сброса или до пробуждения
+        std::unique_lock lock(wake_mutex_);
+        wake_cv_.wait_for(lock, flush_interval, [this] {
+            return !running_ || flush_requested_ || queue_.size() > queue_.capacity() / 2;
+        });
+    }
 }
 
-} // namespace pgw
\ No newline at end of file
+} // namespace pgw
@@ -0,0 +1,60 @@
+#include "CdrRecord.hpp"
+#include "Imsi.hpp"
+
+namespace pgw {
+
+std::string_view to_string(CdrAction action) {
+    switch (action) {
+        case CdrAction::CREATED: return "created";
+        case CdrAction::EXISTS: return "exists";
+        case CdrAction::REJECTED: return "rejected";
+        case CdrAction::EXPIRED: return "expired";
+        case CdrAction::GRACEFUL_REMOVE: return "graceful_remove";
+        case CdrAction::DELETED: return "deleted";
+        case CdrAction::REFRESHED: return "refreshed";
+    }
+    return "unknown";
+}
+
+void append_binary(std::string& out, const CdrRecord& record) {
+    char bytes[kCdrBinaryRecordSize];
+    const uint64_t ms = static_cast<uint64_t>(record.timestamp_ns / 1000000);
+    for (size_t i = 0; i < 8; ++i) {
+        bytes[i] = static_cast<char>(record.imsi >> (8 * i));
+    }
+    for (size_t i = 0; i < 6; ++i) {
+        bytes[8 + i] = static_cast<char>(ms >> (8 * i));
+    }
+    bytes[14] = static_cast<char>(record.action);
+    bytes[15] = 0;
+    out.append(bytes, sizeof(bytes));
+}
+
+std::optional<CdrRecord> decode_binary(const char* data) {
+    const auto* bytes = reinterpret_cast<const unsigned char*>(data);
+    uint64_t imsi = 0;
+    uint64_t ms = 0;
+    for (size_t i = 0; i < 8; ++i) {
+        imsi |= uint64_t(bytes[i]) << (8 * i);
+    }
+    for (size_t i = 0; i < 6; ++i) {
+        ms |= uint64_t(bytes[8 + i]) << (8 * i);
+    }
+    if (bytes[14] > static_cast<uint8_t>(CdrAction::REFRESHED)) {
+        return std::nullopt;
+    }
+    return CdrRecord{static_cast<int64_t>(ms) * 1000000, imsi, static_cast<CdrAction>(bytes[14])};
+}
+
+void append_csv(std::string& out, const CdrRecord& record, TimestampCache& timestamps) {
+    out += timestamps.format(record.timestamp_ns);
+    
+    char imsi_buf[Imsi::kMaxDigits];
+    out += ',';
+    out.append(imsi_buf, Imsi::from_raw(record.imsi).to_chars(imsi_buf));
+    out += ',';
+    out += to_string(record.action);
+    out += '\n';
+}
+
+} // namespace pgw
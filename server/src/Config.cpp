@@ -1,9 +1,35 @@
 #include "Config.hpp"
 #include <fstream>
+#include <initializer_list>
 #include <stdexcept>
+#include <utility>
 
 namespace pgw {
 
+namespace {
+
+// строковый параметр-перечисление; первое значение - по умолчанию.
+// опечатка в значении - ошибка конфига, а не молча выбранный вариант
+template <typename Enum>
+Enum enum_value(const nlohmann::json& config, const std::string& key,
+                std::initializer_list<std::pair<const char*, Enum>> values) {
+    const auto it = config.find(key);
+    if (it == config.end()) {
+        return values.begin()->second;
+    }
+    const auto name = it->get<std::string>();
+    std::string expected;
+    for (const auto& [value_name, value] : values) {
+        if (name == value_name) return value;
+        expected += expected.empty() ? "" : ", ";
+        expected += value_name;
+    }
+    throw std::runtime_error("Config value for " + key + " must be one of " + expected +
+                             ", got: " + name);
+}
+
+} // namespace
+
 ServerConfig load_server_config(const std::string& file_path) {
     std::ifstream file(file_path);
     if (!file.is_open()) {
@@ -27,7 +53,41 @@ ServerConfig load_server_config(const std::string& file_path) {
         .log_file = config["log_file"].get<std::string>(),
         .log_level = config["log_level"].get<std::string>(),
         .blacklist = config["blacklist"].get<std::vector<std::string>>(),
-        .max_sessions = config["max_sessions"].get<unsigned>()
+        .blacklist_file = config.value("blacklist_file", std::string()),
+        .blacklist_load_threads = config.value("blacklist_load_threads", 0u),
+        .max_sessions = config["max_sessions"].get<unsigned>(),
+        .udp_batch_size = config.value("udp_batch_size", 1u),
+        .udp_workers = config.value("udp_workers", 1u),
+        .udp_cpu_affinity = config.value("udp_cpu_affinity", std::vector<int>{}),
+        .udp_backend = enum_value<UdpBackend>(config, "udp_backend",
+            {{"epoll", UdpBackend::EPOLL}, {"io_uring", UdpBackend::IO_URING}}),
+        .session_shards = config.value("session_shards", 16u),
+        .expiry_tick_ms = config.value("expiry_tick_ms", 100u),
+        .cdr_queue_size = config.value("cdr_queue_size", 65536u),
+        .cdr_flush_interval_ms = config.value("cdr_flush_interval_ms", 200u),
+        .cdr_fsync = config.value("cdr_fsync", false),
+        .cdr_overflow = enum_value<OverflowPolicy>(config, "cdr_overflow",
+            {{"block", OverflowPolicy::BLOCK}, {"drop", OverflowPolicy::DROP}}),
+        .cdr_format = enum_value<CdrFormat>(config, "cdr_format",
+            {{"csv", CdrFormat::CSV}, {"binary", CdrFormat::BINARY}}),
+        .cdr_rotate_bytes = config.value("cdr_rotate_bytes", uint64_t{0}),
+        .cdr_rotate_interval_sec = config.value("cdr_rotate_interval_sec", 0u),
+        .cdr_timestamp_millis = config.value("cdr_timestamp_millis", false),
+        .state_dir = config.value("state_dir", std::string()),
+        .snapshot_interval_sec = config.value("snapshot_interval_sec", 60u),
+        .journal_fsync = config.value("journal_fsync", false),
+        .http_threads = config.value("http_threads", 4u),
+        .http_keep_alive_max_count = config.value("http_keep_alive_max_count", 100u),
+        .http_keep_alive_timeout_sec = config.value("http_keep_alive_timeout_sec", 5u),
+        .http_read_timeout_ms = config.value("http_read_timeout_ms", 5000u),
+        .http_write_timeout_ms = config.value("http_write_timeout_ms", 5000u),
+        .http_cpu_affinity = config.value("http_cpu_affinity", std::vector<int>{}),
+        .log_async = config.value("log_async", true),
+        .log_queue_size = config.value("log_queue_size", 8192u),
+        .log_overflow = enum_value<OverflowPolicy>(config, "log_overflow",
+            {{"block", OverflowPolicy::BLOCK}, {"drop", OverflowPolicy::DROP}}),
+        .log_flush_interval_sec = config.value("log_flush_interval_sec", 1u),
+        .log_sample_per_sec = config.value("log_sample_per_sec", 100u)
     };
 }
 
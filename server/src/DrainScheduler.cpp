@@ -0,0 +1,150 @@
+#include "DrainScheduler.hpp"
+#include <spdlog/spdlog.h>
+#include <algorithm>
+
+namespace pgw {
+
+namespace {
+// без ограничения скорости: пачка за тик, чтобы блокировки не держались долго
+constexpr size_t kUnlimitedBatch = 4096;
+}
+
+std::string_view to_string(DrainStatus::State state) {
+    switch (state) {
+        case DrainStatus::State::IDLE: return "idle";
+        case DrainStatus::State::RUNNING: return "running";
+        case DrainStatus::State::COMPLETED: return "completed";
+        case DrainStatus::State::CANCELLED: return "cancelled";
+    }
+    return "unknown";
+}
+
+DrainScheduler::DrainScheduler(SessionManager& session_manager, CDRLogger& cdr_logger)
+    : session_manager_(session_manager),
+      cdr_logger_(cdr_logger) {}
+
+DrainScheduler::~DrainScheduler() {
+    cancel();
+    wait();
+}
+
+bool DrainScheduler::start(unsigned rate, std::function<void()> on_complete) {
+    std::unique_lock lock(mutex_);
+    if (state_ == DrainStatus::State::RUNNING) return false;
+    
+    // поток прошлого запуска после отмены может еще ждать mutex_, чтобы
+    // выйти из run() - дожидаемся его без блокировки
+    while (thread_.joinable()) {
+        std::thread previous = std::move(thread_);
+        lock.unlock();
+        if (previous.get_id() == std::this_thread::get_id()) {
+            previous.detach();  // start() из on_complete: поток уже выходит
+        } else {
+            previous.join();
+        }
+        lock.lock();
+        // пока ждали, другой вызов мог успеть запустить удаление
+        if (state_ == DrainStatus::State::RUNNING) return false;
+    }
+    
+    state_ = DrainStatus::State::RUNNING;
+    rate_ = rate;
+    removed_ = 0;
+    started_at_ = std::chrono::steady_clock::now();
+    session_manager_.set_accepting(false);
+    thread_ = std::thread(&DrainScheduler::run, this, std::move(on_complete));
+    
+    spdlog::info("Graceful shutdown начат: {} сессий, скорость {}/сек",
+                 session_manager_.active_sessions(), rate);
+    return true;
+}
+
+bool DrainScheduler::cancel() {
+    {
+        std::lock_guard lock(mutex_);
+        if (state_ != DrainStatus::State::RUNNING) return false;
+        state_ = DrainStatus::State::CANCELLED;
+        finished_at_ = std::chrono::steady_clock::now();
+        // под блокировкой, как в start(): иначе открытие приема может
+        // обогнать /stop, запущенный сразу после отмены
+        session_manager_.set_accepting(true);
+    }
+    cv_.notify_all();
+    spdlog::info("Graceful shutdown отменен, удалено {} сессий", status().removed);
+    return true;
+}
+
+void DrainScheduler::wait() {
+    std::unique_lock lock(mutex_);
+    cv_.wait(lock, [this] { return state_ != DrainStatus::State::RUNNING; });
+    if (thread_.joinable() && thread_.get_id() != std::this_thread::get_id()) {
+        // поток уже вышел из цикла или выйдет сразу после пробуждения
+        std::thread thread = std::move(thread_);
+        lock.unlock();
+        thread.join();
+    }
+}
+
+DrainStatus DrainScheduler::status() const {
+    std::lock_guard lock(mutex_);
+    DrainStatus status;
+    status.state = state_;
+    status.rate = rate_;
+    status.removed = removed_;
+    status.remaining = session_manager_.active_sessions();
+    if (state_ != DrainStatus::State::IDLE) {
+        const auto end = state_ == DrainStatus::State::RUNNING ? std::chrono::steady_clock::now()
+                                                               : finished_at_;
+        status.elapsed_sec = std::chrono::duration<double>(end - started_at_).count();
+    }
+    return status;
+}
+
+void DrainScheduler::run(std::function<void()> on_complete) {
+    // запас ведра - 100 мс работы, но не меньше одной сессии
+    const double burst = rate_ > 0 ? std::max(1.0, rate_ / 10.0) : 0;
+    double tokens = std::min(burst, 1.0);
+    auto last = std::chrono::steady_clock::now();
+    
+    std::unique_lock lock(mutex_);
+    while (state_ == DrainStatus::State::RUNNING) {
+        size_t budget = kUnlimitedBatch;
+        if (rate_ > 0) {
+            const auto now = std::chrono::steady_clock::now();
+            tokens = std::min(burst, tokens + rate_ * std::chrono::duration<double>(now - last).count());
+            last = now;
+            budget = static_cast<size_t>(tokens);
+        }
+        
+        size_t removed = 0;
+        if (budget > 0) {
+            // блокировки сегментов берем без своей, чтобы status() не ждал
+            lock.unlock();
+            removed = session_manager_.drain_batch(budget, cdr_logger_);
+            lock.lock();
+            removed_ += removed;
+            if (rate_ > 0) tokens -= removed;
+        }
+        
+        if (state_ == DrainStatus::State::RUNNING && session_manager_.active_sessions() == 0) {
+            state_ = DrainStatus::State::COMPLETED;
+            finished_at_ = std::chrono::steady_clock::now();
+            break;
+        }
+        // без ограничения скорости полную пачку продолжаем сразу
+        if (rate_ == 0 && removed == budget) continue;
+        cv_.wait_for(lock, kTick, [this] { return state_ != DrainStatus::State::RUNNING; });
+    }
+    
+    const bool completed = state_ == DrainStatus::State::COMPLETED;
+    const uint64_t removed = removed_;
+    lock.unlock();
+    cv_.notify_all();
+    
+    if (completed) {
+        spdlog::info("Graceful shutdown завершен: удалено {} сессий", removed);
+        if (on_complete) on_complete();
+    }
+}
+
+} // namespace pgw
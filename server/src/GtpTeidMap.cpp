@@ -0,0 +1,142 @@
+#include "GtpTeidMap.hpp"
+#include "SessionManager.hpp"
+#include <cmath>
+#include <functional>
+#include <vector>
+
+namespace pgw {
+
+GtpTeidMap::GtpTeidMap(unsigned shards, unsigned capacity) {
+    while ((1u << shard_bits_) < shards) ++shard_bits_;
+    const size_t count = size_t(1) << shard_bits_;
+    shards_ = std::make_unique<Shard[]>(count);
+    if (capacity == 0) return;
+    
+    // доля сегмента с запасом на неравномерность хеша, как у таблиц сессий
+    const double expected = std::ceil(double(capacity) / count);
+    const size_t per_shard = static_cast<size_t>(expected + 4 * std::sqrt(expected) + 8);
+    for (size_t i = 0; i < count; ++i) {
+        Shard& shard = shards_[i];
+        shard.by_teid.reserve(per_shard);
+        shard.by_imsi.reserve(per_shard);
+        shard.spare_teids.reserve(per_shard);
+        shard.spare_imsis.reserve(per_shard);
+        for (uint32_t key = 0; key < per_shard; ++key) {
+            shard.spare_teids.push_back(shard.by_teid.extract(shard.by_teid.emplace(key, Binding{}).first));
+            shard.spare_imsis.push_back(shard.by_imsi.extract(
+                shard.by_imsi.emplace(Imsi::from_raw(key + 1), 0).first));
+        }
+    }
+}
+
+void GtpTeidMap::insert(Shard& shard, uint32_t teid, const Binding& binding) {
+    if (shard.spare_teids.empty()) {
+        shard.by_teid.emplace(teid, binding);
+    } else {
+        auto node = std::move(shard.spare_teids.back());
+        shard.spare_teids.pop_back();
+        node.key() = teid;
+        node.mapped() = binding;
+        shard.by_teid.insert(std::move(node));
+    }
+    if (shard.spare_imsis.empty()) {
+        shard.by_imsi.emplace(binding.imsi, teid);
+    } else {
+        auto node = std::move(shard.spare_imsis.back());
+        shard.spare_imsis.pop_back();
+        node.key() = binding.imsi;
+        node.mapped() = teid;
+        shard.by_imsi.insert(std::move(node));
+    }
+}
+
+void GtpTeidMap::erase(Shard& shard, TeidIndex::iterator it) {
+    auto imsi_node = shard.by_imsi.extract(it->second.imsi);
+    if (!imsi_node.empty()) shard.spare_imsis.push_back(std::move(imsi_node));
+    shard.spare_teids.push_back(shard.by_teid.extract(it));
+}
+
+GtpTeidMap::Shard& GtpTeidMap::shard_for(Imsi imsi) {
+    const uint64_t hash = std::hash<Imsi>{}(imsi);
+    return shards_[(hash >> 32) & ((1u << shard_bits_) - 1)];
+}
+
+uint32_t GtpTeidMap::bind(Imsi imsi, uint32_t peer_teid) {
+    Shard& shard = shard_for(imsi);
+    const uint32_t index = &shard - shards_.get();
+    std::lock_guard lock(shard.mutex);
+    
+    auto it = shard.by_imsi.find(imsi);
+    if (it != shard.by_imsi.end()) {
+        shard.by_teid.find(it->second)->second.peer_teid = peer_teid;
+        return it->second;
+    }
+    
+    // TEID = (счетчик << shard_bits) | сегмент; после переполнения счетчика
+    // пропускаем занятые значения и 0
+    uint32_t teid;
+    do {
+        teid = (shard.next_id++ << shard_bits_) | index;
+    } while (teid == 0 || shard.by_teid.count(teid));
+    
+    insert(shard, teid, Binding{imsi, peer_teid});
+    return teid;
+}
+
+std::optional<GtpTeidMap::Binding> GtpTeidMap::find(uint32_t teid) const {
+    const Shard& shard = shards_[teid & ((1u << shard_bits_) - 1)];
+    std::lock_guard lock(shard.mutex);
+    auto it = shard.by_teid.find(teid);
+    if (it == shard.by_teid.end()) return std::nullopt;
+    return it->second;
+}
+
+std::optional<GtpTeidMap::Binding> GtpTeidMap::release(uint32_t teid) {
+    Shard& shard = shards_[teid & ((1u << shard_bits_) - 1)];
+    std::lock_guard lock(shard.mutex);
+    auto it = shard.by_teid.find(teid);
+    if (it == shard.by_teid.end()) return std::nullopt;
+    
+    const Binding binding = it->second;
+    erase(shard, it);
+    return binding;
+}
+
+size_t GtpTeidMap::prune(const SessionManager& session_manager) {
+    size_t removed = 0;
+    std::vector<Imsi> imsis;
+    for (size_t i = 0; i < (size_t(1) << shard_bits_); ++i) {
+        Shard& shard = shards_[i];
+        
+        // отбираем кандидатов без блокировки сегмента, чтобы не держать
+        // две блокировки на каждую привязку
+        imsis.clear();
+        {
+            std::lock_guard lock(shard.mutex);
+            for (const auto& [imsi, teid] : shard.by_imsi) imsis.push_back(imsi);
+        }
+        for (Imsi imsi : imsis) {
+            if (session_manager.is_active(imsi)) continue;
+            // между проверкой и блокировкой Create Session мог создать сессию
+            // заново и получить этот TEID: проверяем еще раз под блокировкой
+            // (порядок блокировок TEID -> сессия, обратного нигде нет)
+            std::lock_guard lock(shard.mutex);
+            auto it = shard.by_imsi.find(imsi);
+            if (it == shard.by_imsi.end() || session_manager.is_active(imsi)) continue;
+            erase(shard, shard.by_teid.find(it->second));
+            removed++;
+        }
+    }
+    return removed;
+}
+
+size_t GtpTeidMap::size() const {
+    size_t total = 0;
+    for (size_t i = 0; i < (size_t(1) << shard_bits_); ++i) {
+        std::lock_guard lock(shards_[i].mutex);
+        total += shards_[i].by_teid.size();
+    }
+    return total;
+}
+
+} // namespace pgw
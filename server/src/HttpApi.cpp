@@ -1,18 +1,81 @@
 #include "HttpApi.hpp"
+#include "Metrics.hpp"
 #include <spdlog/spdlog.h>
+#include <nlohmann/json.hpp>
+#include <spdlog/fmt/ranges.h>
+#include <pthread.h>
+#include <sched.h>
+#include <algorithm>
+#include <cstring>
+#include <memory>
+#include <string_view>
+#include <vector>
 
 namespace pgw {
 
+namespace {
+
+// ограничение размера пакетной проверки: ответ собирается в памяти целиком
+constexpr size_t kMaxBulkImsis = 100000;
+
+// тело POST /check_subscribers: JSON-массив строк, {"imsis": [...]}
+// или по одному IMSI в строке
+bool parse_imsi_list(const httplib::Request& req, std::vector<std::string>& out, std::string& error) {
+    const std::string_view body = req.body;
+    const size_t first = body.find_first_not_of(" \t\r\n");
+    if (first != std::string_view::npos && (body[first] == '[' || body[first] == '{')) {
+        try {
+            auto json = nlohmann::json::parse(body);
+            const auto& list = json.is_object() ? json.at("imsis") : json;
+            out = list.get<std::vector<std::string>>();
+            return true;
+        } catch (const std::exception& e) {
+            error = e.what();
+            return false;
+        }
+    }
+    
+    for (size_t pos = 0; pos < body.size(); ) {
+        size_t end = body.find('\n', pos);
+        if (end == std::string_view::npos) end = body.size();
+        std::string_view line = body.substr(pos, end - pos);
+        while (!line.empty() && (line.back() == '\r' || line.back() == ' ')) line.remove_suffix(1);
+        if (!line.empty()) out.emplace_back(line);
+        pos = end + 1;
+    }
+    return true;
+}
+
+// привязка текущего потока к набору CPU
+void pin_to_cpus(const std::vector<int>& cpus) {
+    if (cpus.empty()) return;
+    
+    cpu_set_t cpuset;
+    CPU_ZERO(&cpuset);
+    for (int cpu : cpus) CPU_SET(cpu, &cpuset);
+    int rc = pthread_setaffinity_np(pthread_self(), sizeof(cpuset), &cpuset);
+    if (rc != 0) {
+        spdlog::warn("Не удалось закрепить потоки HTTP за CPU {}: {}", fmt::join(cpus, ","), strerror(rc));
+    } else {
+        spdlog::debug("Потоки HTTP закреплены за CPU {}", fmt::join(cpus, ","));
+    }
+}
+
+} // namespace
+
 HttpApi::HttpApi(uint16_t port, 
                  SessionManager& session_manager,
                  CDRLogger& cdr_logger,
                  std::atomic<bool>& shutdown_requested,
-                 unsigned graceful_shutdown_rate)
+                 unsigned graceful_shutdown_rate,
+                 const HttpOptions& options)
     : port_(port),
       session_manager_(session_manager),
       cdr_logger_(cdr_logger),
       shutdown_requested_(shutdown_requested),
-      graceful_shutdown_rate_(graceful_shutdown_rate) {
+      graceful_shutdown_rate_(graceful_shutdown_rate),
+      options_(options),
+      drain_(session_manager, cdr_logger) {
     
     spdlog::debug("HTTP API инициализирован на порту {}", port);
 }
@@ -27,10 +90,20 @@ void HttpApi::run() {
     running_ = true;
     server_ = std::make_unique<httplib::Server>();
     
+    const size_t threads = std::max(options_.threads, 1u);
+    server_->new_task_queue = [threads] { return new httplib::ThreadPool(threads); };
+    server_->set_keep_alive_max_count(options_.keep_alive_max_count);
+    server_->set_keep_alive_timeout(options_.keep_alive_timeout_sec);
+    server_->set_read_timeout(std::chrono::milliseconds(options_.read_timeout_ms));
+    server_->set_write_timeout(std::chrono::milliseconds(options_.write_timeout_ms));
+    
     setup_routes();
     
     server_thread_ = std::thread([this] {
-        spdlog::info("HTTP сервер запущен на порту {}", port_);
+        // пул обработчиков создается из этого потока внутри listen()
+        // и наследует его привязку к CPU
+        pin_to_cpus(options_.cpu_affinity);
+        spdlog::info("HTTP сервер запущен на порту {} ({} потоков)", port_, std::max(options_.threads, 1u));
         server_->listen("0.0.0.0", port_);
     });
 }
@@ -61,26 +134,194 @@ void HttpApi::setup_routes() {
             return;
         }
         
-        bool active = session_manager_.is_active(imsi);
+        auto parsed = Imsi::parse(imsi);
+        if (!parsed) {
+            res.status = 400;
+            res.set_content("Error: invalid IMSI", "text/plain");
+            spdlog::warn("HTTP /check_subscriber: invalid IMSI '{}'", imsi);
+            return;
+        }
+        
+        bool active = session_manager_.is_active(*parsed);
         res.set_content(active ? "active" : "not active", "text/plain");
         spdlog::debug("HTTP /check_subscriber: IMSI={} -> {}", imsi, active ? "active" : "not active");
     });
     
-    // запрос на остановку сервера
-    server_->Get("/stop", [this](const httplib::Request&, httplib::Response& res) {
-        res.set_content("Initiating graceful shutdown...", "text/plain");
-        spdlog::info("Получен HTTP запрос /stop, инициирую graceful shutdown");
+    // пакетная проверка: состояние, время простоя и остаток таймаута
+    // для списка IMSI, каждый сегмент таблицы блокируется один раз
+    server_->Post("/check_subscribers", [this](const httplib::Request& req, httplib::Response& res) {
+        std::vector<std::string> raw;
+        std::string error;
+        if (!parse_imsi_list(req, raw, error)) {
+            res.status = 400;
+            res.set_content("Error: invalid IMSI list: " + error, "text/plain");
+            return;
+        }
+        if (raw.size() > kMaxBulkImsis) {
+            res.status = 413;
+            res.set_content(fmt::format("Error: at most {} IMSIs per request", kMaxBulkImsis), "text/plain");
+            return;
+        }
         
-        // запускаем graceful shutdown в отдельном потоке
-        std::thread shutdown_thread(&HttpApi::graceful_shutdown_handler, this);
-        shutdown_thread.detach();
+        // некорректные IMSI в таблицу не передаем
+        std::vector<Imsi> imsis;
+        std::vector<std::optional<size_t>> positions(raw.size());
+        imsis.reserve(raw.size());
+        for (size_t i = 0; i < raw.size(); ++i) {
+            if (auto imsi = Imsi::parse(raw[i])) {
+                positions[i] = imsis.size();
+                imsis.push_back(*imsi);
+            }
+        }
+        const auto last_seen = session_manager_.last_seen_batch(imsis);
+        const auto now = std::chrono::steady_clock::now();
+        const auto timeout = session_manager_.session_timeout();
+        
+        std::string body = "{\"results\":[";
+        body.reserve(raw.size() * 64);
+        auto it = std::back_inserter(body);
+        for (size_t i = 0; i < raw.size(); ++i) {
+            if (i > 0) body += ',';
+            if (!positions[i]) {
+                fmt::format_to(it, "{{\"imsi\":{},\"state\":\"invalid\"}}", nlohmann::json(raw[i]).dump());
+                continue;
+            }
+            const auto& seen = last_seen[*positions[i]];
+            if (!seen) {
+                fmt::format_to(it, "{{\"imsi\":\"{}\",\"state\":\"not active\"}}", imsis[*positions[i]]);
+                continue;
+            }
+            const auto idle = std::chrono::duration_cast<std::chrono::milliseconds>(now - *seen);
+            const auto ttl = std::max(std::chrono::milliseconds(timeout) - idle, std::chrono::milliseconds(0));
+            fmt::format_to(it, "{{\"imsi\":\"{}\",\"state\":\"active\",\"idle_ms\":{},\"ttl_ms\":{}}}",
+                           imsis[*positions[i]], idle.count(), ttl.count());
+        }
+        body += "]}";
+        res.set_content(body, "application/json");
+        spdlog::debug("HTTP /check_subscribers: {} IMSI", raw.size());
+    });
+    
+    // выгрузка всех активных сессий для сверки: CSV потоком, по сегменту
+    // на порцию, каждый сегмент блокируется только на время копирования
+    server_->Get("/sessions", [this](const httplib::Request&, httplib::Response& res) {
+        auto next_shard = std::make_shared<size_t>(0);
+        res.set_chunked_content_provider("text/csv",
+            [this, next_shard](size_t, httplib::DataSink& sink) {
+                std::string chunk;
+                if (*next_shard == 0) chunk = "imsi,idle_ms,ttl_ms\n";
+                if (*next_shard >= session_manager_.shards()) {
+                    sink.done();
+                    return true;
+                }
+                
+                std::vector<std::pair<Imsi, std::chrono::steady_clock::time_point>> sessions;
+                session_manager_.copy_shard((*next_shard)++, sessions);
+                const auto now = std::chrono::steady_clock::now();
+                const auto timeout = std::chrono::milliseconds(session_manager_.session_timeout());
+                auto it = std::back_inserter(chunk);
+                for (const auto& [imsi, seen] : sessions) {
+                    const auto idle = std::chrono::duration_cast<std::chrono::milliseconds>(now - seen);
+                    fmt::format_to(it, "{},{},{}\n", imsi, idle.count(),
+                                   std::max(timeout - idle, std::chrono::milliseconds(0)).count());
+                }
+                return chunk.empty() || sink.write(chunk.data(), chunk.size());
+            });
+    });
+    
+    // метрики в текстовом формате Prometheus
+    server_->Get("/metrics", [this](const httplib::Request&, httplib::Response& res) {
+        std::string body = Metrics::render();
+        Metrics::append_sample(body, "pgw_active_sessions", "gauge",
+                               "Active sessions", session_manager_.active_sessions());
+        Metrics::append_sample(body, "pgw_cdr_queue_depth", "gauge",
+                               "CDR records waiting for the writer", cdr_logger_.queue_depth());
+        Metrics::append_sample(body, "pgw_cdr_written_total", "counter",
+                               "CDR records written to disk", cdr_logger_.written());
+        Metrics::append_sample(body, "pgw_cdr_dropped_total", "counter",
+                               "CDR records lost on queue overflow or write errors", cdr_logger_.dropped());
+        Metrics::append_sample(body, "pgw_cdr_rotations_total", "counter",
+                               "CDR file rotations", cdr_logger_.rotations());
+        Metrics::append_sample(body, "pgw_draining", "gauge", "Graceful shutdown in progress",
+                               drain_.status().state == DrainStatus::State::RUNNING ? 1 : 0);
+        res.set_content(body, "text/plain; version=0.0.4");
+    });
+    
+    // запрос на остановку сервера: сессии удаляются в фоне с заданной
+    // скоростью (rate - сессий в секунду, по умолчанию из конфига),
+    // после удаления последней сервер останавливается
+    server_->Get("/stop", [this](const httplib::Request& req, httplib::Response& res) {
+        unsigned rate = graceful_shutdown_rate_;
+        if (req.has_param("rate")) {
+            try {
+                rate = std::stoul(req.get_param_value("rate"));
+            } catch (const std::exception&) {
+                res.status = 400;
+                res.set_content("Error: invalid rate", "text/plain");
+                return;
+            }
+        }
+        
+        spdlog::info("Получен HTTP запрос /stop, инициирую graceful shutdown");
+        if (!drain_.start(rate, [this] {
+                shutdown_requested_ = true;
+                if (shutdown_handler_) shutdown_handler_();
+            })) {
+            res.status = 409;
+            res.set_content("Graceful shutdown already in progress", "text/plain");
+            return;
+        }
+        res.set_content("Initiating graceful shutdown...", "text/plain");
+    });
+    
+    // прогресс graceful shutdown
+    server_->Get("/stop/status", [this](const httplib::Request&, httplib::Response& res) {
+        const DrainStatus status = drain_.status();
+        nlohmann::json body = {
+            {"state", to_string(status.state)},
+            {"rate", status.rate},
+            {"removed", status.removed},
+            {"remaining", status.remaining},
+            {"elapsed_sec", status.elapsed_sec}
+        };
+        // оценка оставшегося времени при ограниченной скорости
+        if (status.state == DrainStatus::State::RUNNING && status.rate > 0) {
+            body["eta_sec"] = double(status.remaining) / status.rate;
+        }
+        res.set_content(body.dump(), "application/json");
+    });
+    
+    // отмена graceful shutdown: прием новых сессий возобновляется
+    server_->Get("/stop/cancel", [this](const httplib::Request&, httplib::Response& res) {
+        if (!drain_.cancel()) {
+            res.status = 409;
+            res.set_content("Graceful shutdown is not running", "text/plain");
+            return;
+        }
+        res.set_content("Graceful shutdown cancelled", "text/plain");
+    });
+    
+    // перезагрузка черного списка и лимитов из конфига без перезапуска
+    server_->Get("/reload", [this](const httplib::Request&, httplib::Response& res) {
+        if (!reload_handler_) {
+            res.status = 501;
+            res.set_content("Reload is not configured", "text/plain");
+            return;
+        }
+        try {
+            reload_handler_();
+        } catch (const std::exception& e) {
+            spdlog::error("HTTP /reload: {}", e.what());
+            res.status = 500;
+            res.set_content(std::string("Error: ") + e.what(), "text/plain");
+            return;
+        }
+        const auto policy = session_manager_.policy();
+        res.set_content(fmt::format("Configuration reloaded: max_sessions={}, session_timeout_sec={}, blacklist={}",
+                                    policy->max_sessions, policy->session_timeout.count(),
+                                    policy->blacklist.exact_count() + policy->blacklist.prefix_count() +
+                                    policy->blacklist.range_count()),
+                        "text/plain");
     });
-}
-
-void HttpApi::graceful_shutdown_handler() {
-    shutdown_requested_ = true;
-    spdlog::info("Graceful shutdown начат со скоростью {}/сек", graceful_shutdown_rate_);
-    session_manager_.graceful_shutdown(graceful_shutdown_rate_, cdr_logger_);
 }
 
 } // namespace pgw
\ No newline at end of file
@@ -0,0 +1,83 @@
+#include "LogSampler.hpp"
+#include "TimestampCache.hpp"
+#include <algorithm>
+#include <mutex>
+#include <vector>
+
+namespace pgw {
+
+namespace {
+
+constexpr int64_t kWindowNs = 1'000'000'000;
+
+// реестр экземпляров для report_all(); функция, а не глобальная
+// переменная - экземпляры сами бывают глобальными в других единицах трансляции
+struct Registry {
+    std::mutex mutex;
+    std::vector<LogSampler*> samplers;
+};
+
+Registry& registry() {
+    static Registry instance;
+    return instance;
+}
+
+} // namespace
+
+std::atomic<unsigned> LogSampler::rate_{100};
+
+LogSampler::LogSampler(const char* name, spdlog::level::level_enum level)
+    : name_(name), level_(level) {
+    auto& reg = registry();
+    std::lock_guard lock(reg.mutex);
+    reg.samplers.push_back(this);
+}
+
+LogSampler::~LogSampler() {
+    auto& reg = registry();
+    std::lock_guard lock(reg.mutex);
+    reg.samplers.erase(std::remove(reg.samplers.begin(), reg.samplers.end(), this), reg.samplers.end());
+}
+
+bool LogSampler::allow() {
+    if (!spdlog::should_log(level_)) return false;
+    
+    const unsigned limit = rate();
+    if (limit == 0) return true;
+    
+    roll(TimestampCache::coarse_now_ns());
+    if (in_window_.fetch_add(1, std::memory_order_relaxed) < limit) return true;
+    
+    suppressed_.fetch_add(1, std::memory_order_relaxed);
+    suppressed_total_.fetch_add(1, std::memory_order_relaxed);
+    return false;
+}
+
+void LogSampler::roll(int64_t now_ns) {
+    int64_t start = window_start_ns_.load(std::memory_order_relaxed);
+    if (now_ns - start < kWindowNs) return;
+    // окно закрывает один поток, остальные продолжают считать в новом
+    if (!window_start_ns_.compare_exchange_strong(start, now_ns, std::memory_order_relaxed)) return;
+    
+    in_window_.store(0, std::memory_order_relaxed);
+    const uint64_t skipped = suppressed_.exchange(0, std::memory_order_relaxed);
+    if (skipped > 0) {
+        spdlog::log(level_, "{}: еще {} сообщений за {:.1f} с пропущено",
+                    name_, skipped, static_cast<double>(now_ns - start) / kWindowNs);
+    }
+}
+
+void LogSampler::report_all() {
+    if (rate() == 0) return;
+    
+    const int64_t now = TimestampCache::coarse_now_ns();
+    auto& reg = registry();
+    std::lock_guard lock(reg.mutex);
+    for (LogSampler* sampler : reg.samplers) {
+        if (sampler->suppressed_.load(std::memory_order_relaxed) > 0) {
+            sampler->roll(now);
+        }
+    }
+}
+
+} // namespace pgw
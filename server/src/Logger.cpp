@@ -1,4 +1,6 @@
 #include "Logger.hpp"
+#include "LogSampler.hpp"
+#include <spdlog/async.h>
 #include <spdlog/sinks/rotating_file_sink.h>
 #include <spdlog/sinks/stdout_color_sinks.h>
 #include <iostream>
@@ -8,7 +10,8 @@ namespace pgw {
 
 static std::shared_ptr<spdlog::logger> global_logger;
 
-void Logger::init(const std::string& log_file, const std::string& level) {
+void Logger::init(const std::string& log_file, const std::string& level,
+                  const LoggerOptions& options) {
     static std::once_flag logger_init_flag;
     std::call_once(logger_init_flag, [&]() {
         try {
@@ -20,9 +23,19 @@ void Logger::init(const std::string& log_file, const std::string& level) {
             console_sink->set_level(spdlog::level::trace);
             file_sink->set_level(spdlog::level::trace);
             
-            global_logger = std::make_shared<spdlog::logger>("pgw", 
-                spdlog::sinks_init_list{console_sink, file_sink}
-            );
+            // в асинхронном режиме поток запроса только кладет сообщение
+            // в очередь, форматирование в синки и запись - в потоке spdlog
+            spdlog::sinks_init_list sinks{console_sink, file_sink};
+            if (options.async) {
+                spdlog::init_thread_pool(options.queue_size, 1);
+                const auto policy = options.block_when_full
+                    ? spdlog::async_overflow_policy::block
+                    : spdlog::async_overflow_policy::overrun_oldest;
+                global_logger = std::make_shared<spdlog::async_logger>("pgw", sinks,
+                    spdlog::thread_pool(), policy);
+            } else {
+                global_logger = std::make_shared<spdlog::logger>("pgw", sinks);
+            }
             
             if (level == "debug") global_logger->set_level(spdlog::level::debug);
             else if (level == "info") global_logger->set_level(spdlog::level::info);
@@ -33,15 +46,21 @@ void Logger::init(const std::string& log_file, const std::string& level) {
             
             global_logger->set_pattern("[%Y-%m-%d %H:%M:%S.%e] [%n] [%^%l%$] %v");
             
-            global_logger->flush_on(spdlog::level::trace);
+            // ошибки сразу на диск, остальное - периодически
+            global_logger->flush_on(spdlog::level::warn);
+            LogSampler::set_rate(options.sample_per_sec);
             
             spdlog::register_logger(global_logger);
             spdlog::set_default_logger(global_logger);
             
             global_logger->flush();
+            if (options.flush_interval_sec > 0) {
+                spdlog::flush_every(std::chrono::seconds(options.flush_interval_sec));
+            }
             
             global_logger->info("Логгер инициализирован. Файл: {}", log_file);
-            global_logger->debug("Уровень логирования: {}", level);
+            global_logger->debug("Уровень логирования: {}, async={}, очередь {}, не больше {} сообщений/с с одного места",
+                                 level, options.async, options.queue_size, options.sample_per_sec);
             
         } catch (const spdlog::spdlog_ex& ex) {
             std::cerr << "SPDLOG error: " << ex.what() << std::endl;
@@ -0,0 +1,90 @@
+#include "Metrics.hpp"
+#include <iterator>
+#include <spdlog/fmt/fmt.h>
+
+namespace pgw {
+
+namespace {
+
+struct MetricInfo {
+    std::string_view name;
+    std::string_view labels;
+    std::string_view help;
+};
+
+// порядок совпадает с enum Metric; одинаковые имена идут подряд
+constexpr MetricInfo kMetricInfo[] = {
+    {"pgw_udp_packets_received_total", "", "UDP datagrams received"},
+    {"pgw_session_requests_total", "result=\"created\"", "Session create requests by result"},
+    {"pgw_session_requests_total", "result=\"exists\"", ""},
+    {"pgw_session_requests_total", "result=\"rejected_blacklist\"", ""},
+    {"pgw_session_requests_total", "result=\"rejected_limit\"", ""},
+    {"pgw_session_requests_total", "result=\"rejected_invalid\"", ""},
+    {"pgw_udp_send_errors_total", "", "UDP replies that failed to send"},
+    {"pgw_sessions_removed_total", "reason=\"expired\"", "Sessions removed by reason"},
+    {"pgw_sessions_removed_total", "reason=\"graceful\"", ""},
+    {"pgw_sessions_removed_total", "reason=\"deleted\"", ""},
+    {"pgw_session_refreshes_total", "", "Sessions extended by refresh requests"},
+    {"pgw_udp_malformed_packets_total", "", "Binary and GTP packets dropped as malformed"},
+};
+static_assert(std::size(kMetricInfo) == static_cast<size_t>(Metric::COUNT));
+
+} // namespace
+
+uint64_t Metrics::value(Metric metric) {
+    uint64_t sum = 0;
+    for (const auto& stripe : stripes_) {
+        sum += stripe.counters[static_cast<unsigned>(metric)].load(std::memory_order_relaxed);
+    }
+    return sum;
+}
+
+void Metrics::append_sample(std::string& out, std::string_view name, std::string_view type,
+                            std::string_view help, uint64_t value) {
+    fmt::format_to(std::back_inserter(out), "# HELP {0} {1}\n# TYPE {0} {2}\n{0} {3}\n",
+                   name, help, type, value);
+}
+
+std::string Metrics::render() {
+    std::string out;
+    auto it = std::back_inserter(out);
+    
+    std::string_view previous;
+    for (size_t i = 0; i < kCounters; ++i) {
+        const auto& info = kMetricInfo[i];
+        if (info.name != previous) {
+            fmt::format_to(it, "# HELP {0} {1}\n# TYPE {0} counter\n", info.name, info.help);
+            previous = info.name;
+        }
+        const uint64_t total = value(static_cast<Metric>(i));
+        if (info.labels.empty()) {
+            fmt::format_to(it, "{} {}\n", info.name, total);
+        } else {
+            fmt::format_to(it, "{}{{{}}} {}\n", info.name, info.labels, total);
+        }
+    }
+    
+    // гистограмма: корзины в Prometheus накопительные
+    uint64_t buckets[kLatencyBucketsNs.size() + 1] = {};
+    uint64_t sum_ns = 0;
+    for (const auto& stripe : stripes_) {
+        for (size_t b = 0; b < std::size(buckets); ++b) {
+            buckets[b] += stripe.buckets[b].load(std::memory_order_relaxed);
+        }
+        sum_ns += stripe.latency_sum_ns.load(std::memory_order_relaxed);
+    }
+    
+    constexpr std::string_view name = "pgw_request_duration_seconds";
+    fmt::format_to(it, "# HELP {0} UDP request processing time\n# TYPE {0} histogram\n", name);
+    uint64_t cumulative = 0;
+    for (size_t b = 0; b < kLatencyBucketsNs.size(); ++b) {
+        cumulative += buckets[b];
+        fmt::format_to(it, "{}_bucket{{le=\"{}\"}} {}\n", name, kLatencyBucketsNs[b] / 1e9, cumulative);
+    }
+    cumulative += buckets[kLatencyBucketsNs.size()];
+    fmt::format_to(it, "{}_bucket{{le=\"+Inf\"}} {}\n", name, cumulative);
+    fmt::format_to(it, "{}_sum {}\n{}_count {}\n", name, sum_ns / 1e9, name, cumulative);
+    return out;
+}
+
+} // namespace pgw
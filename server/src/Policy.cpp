@@ -0,0 +1,25 @@
+#include "Policy.hpp"
+#include "Config.hpp"
+#include <spdlog/spdlog.h>
+
+namespace pgw {
+
+std::unique_ptr<const Policy> make_policy(const ServerConfig& config) {
+    auto policy = std::make_unique<Policy>();
+    for (const auto& entry : config.blacklist) {
+        policy->blacklist.add(entry);
+    }
+    if (!config.blacklist_file.empty()) {
+        policy->blacklist.load_file(config.blacklist_file, config.blacklist_load_threads);
+    }
+    policy->blacklist.build();
+    policy->max_sessions = config.max_sessions;
+    policy->session_timeout = std::chrono::seconds(config.session_timeout_sec);
+    
+    spdlog::info("Черный список: {} IMSI, {} префиксов, {} диапазонов, фильтр {} КБ",
+                 policy->blacklist.exact_count(), policy->blacklist.prefix_count(),
+                 policy->blacklist.range_count(), policy->blacklist.filter_bytes() / 1024);
+    return policy;
+}
+
+} // namespace pgw
@@ -0,0 +1,156 @@
+#include "Reactor.hpp"
+#include <spdlog/spdlog.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/signalfd.h>
+#include <sys/timerfd.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <csignal>
+#include <cstring>
+#include <stdexcept>
+
+namespace pgw {
+
+namespace {
+
+constexpr int kMaxEvents = 64;
+
+std::runtime_error system_error(const char* what) {
+    return std::runtime_error(std::string(what) + ": " + strerror(errno));
+}
+
+timespec to_timespec(std::chrono::nanoseconds value) {
+    const auto seconds = std::chrono::duration_cast<std::chrono::seconds>(value);
+    return timespec{static_cast<time_t>(seconds.count()), static_cast<long>((value - seconds).count())};
+}
+
+sigset_t signal_set(std::initializer_list<int> signals) {
+    sigset_t set;
+    sigemptyset(&set);
+    for (int signal : signals) sigaddset(&set, signal);
+    return set;
+}
+
+} // namespace
+
+Reactor::Reactor() {
+    epoll_fd_ = epoll_create1(EPOLL_CLOEXEC);
+    if (epoll_fd_ < 0) throw system_error("ошибка создания epoll");
+    
+    wake_fd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (wake_fd_ < 0) {
+        close(epoll_fd_);
+        throw system_error("ошибка создания eventfd");
+    }
+    // пробуждение отличаем по пустому указателю
+    epoll_event event{};
+    event.events = EPOLLIN;
+    event.data.ptr = nullptr;
+    epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, wake_fd_, &event);
+}
+
+Reactor::~Reactor() {
+    for (const auto& watch : watches_) {
+        if (watch->owned) close(watch->fd);
+    }
+    close(wake_fd_);
+    close(epoll_fd_);
+}
+
+Reactor::Watch& Reactor::watch(int fd, bool owned, uint32_t events, Handler handler) {
+    watches_.push_back(std::make_unique<Watch>(Watch{fd, owned, std::move(handler)}));
+    epoll_event event{};
+    event.events = events;
+    event.data.ptr = watches_.back().get();
+    if (epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, fd, &event) < 0) {
+        if (owned) close(fd);
+        watches_.pop_back();
+        throw system_error("ошибка добавления дескриптора в epoll");
+    }
+    return *watches_.back();
+}
+
+void Reactor::add(int fd, uint32_t events, Handler handler) {
+    watch(fd, false, events, std::move(handler));
+}
+
+void Reactor::remove(int fd) {
+    auto it = std::find_if(watches_.begin(), watches_.end(),
+                           [fd](const auto& watch) { return !watch->owned && watch->fd == fd; });
+    if (it == watches_.end()) return;
+    epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, fd, nullptr);
+    watches_.erase(it);
+}
+
+Reactor::TimerId Reactor::add_timer(std::function<void()> callback) {
+    const int fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    if (fd < 0) throw system_error("ошибка создания timerfd");
+    
+    watch(fd, true, EPOLLIN, [fd, callback = std::move(callback)](uint32_t) {
+        // пропущенные срабатывания схлопываются в один вызов
+        uint64_t expirations;
+        if (read(fd, &expirations, sizeof(expirations)) == sizeof(expirations)) callback();
+    });
+    timer_fds_.push_back(fd);
+    return timer_fds_.size() - 1;
+}
+
+void Reactor::arm_timer(TimerId timer, std::chrono::nanoseconds delay, std::chrono::nanoseconds interval) {
+    itimerspec spec{};
+    spec.it_value = to_timespec(delay);
+    spec.it_interval = to_timespec(interval);
+    if (timerfd_settime(timer_fds_.at(timer), 0, &spec, nullptr) < 0) {
+        throw system_error("ошибка настройки timerfd");
+    }
+}
+
+void Reactor::block_signals(std::initializer_list<int> signals) {
+    const sigset_t set = signal_set(signals);
+    pthread_sigmask(SIG_BLOCK, &set, nullptr);
+}
+
+void Reactor::add_signals(std::initializer_list<int> signals, std::function<void(int)> callback) {
+    const sigset_t set = signal_set(signals);
+    const int fd = signalfd(-1, &set, SFD_NONBLOCK | SFD_CLOEXEC);
+    if (fd < 0) throw system_error("ошибка создания signalfd");
+    
+    watch(fd, true, EPOLLIN, [fd, callback = std::move(callback)](uint32_t) {
+        signalfd_siginfo info;
+        while (read(fd, &info, sizeof(info)) == sizeof(info)) {
+            callback(static_cast<int>(info.ssi_signo));
+        }
+    });
+}
+
+void Reactor::run() {
+    epoll_event events[kMaxEvents];
+    while (!stopping()) {
+        const int n = epoll_wait(epoll_fd_, events, kMaxEvents, -1);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            spdlog::error("Ошибка epoll_wait: {}", strerror(errno));
+            break;
+        }
+        for (int i = 0; i < n && !stopping(); ++i) {
+            auto* watch = static_cast<Watch*>(events[i].data.ptr);
+            if (!watch) {
+                uint64_t value;
+                while (read(wake_fd_, &value, sizeof(value)) == sizeof(value)) {}
+                continue;
+            }
+            watch->handler(events[i].events);
+        }
+    }
+}
+
+void Reactor::stop() {
+    // только async-signal-safe операции: атомарный флаг и write
+    stop_requested_.store(true, std::memory_order_release);
+    const uint64_t one = 1;
+    [[maybe_unused]] ssize_t n = write(wake_fd_, &one, sizeof(one));
+}
+
+} // namespace pgw
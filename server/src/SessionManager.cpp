@@ -1,121 +1,360 @@
 #include "SessionManager.hpp"
 #include "CDRLogger.hpp"
+#include "Metrics.hpp"
+#include "SessionStore.hpp"
+#include "LogSampler.hpp"
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <vector>
 
 namespace pgw {
 
 using namespace std::chrono;
 
+namespace {
+
+// округляем число сегментов до степени двойки, чтобы индекс брать маской
+size_t shard_count(unsigned requested) {
+    size_t count = 1;
+    while (count < requested) count <<= 1;
+    return count;
+}
+
+// емкость таблицы сегмента: ожидаемая доля max_sessions плюс запас
+// на неравномерность хеша (4 сигмы), с заполнением не выше ~3/4
+size_t shard_capacity(unsigned max_sessions, size_t shards) {
+    const double expected = std::ceil(double(max_sessions) / shards);
+    const double with_slack = expected + 4 * std::sqrt(expected) + 8;
+    return static_cast<size_t>(with_slack * 4 / 3);
+}
+
+// запись в журнал под блокировкой сегмента, чтобы порядок записей
+// одного IMSI совпадал с порядком изменений
+void journal(const std::atomic<SessionStore*>& store, SessionStore::Op op, Imsi imsi) {
+    if (SessionStore* s = store.load(std::memory_order_acquire)) s->record(op, imsi);
+}
+
+std::unique_ptr<const Policy> policy_of(unsigned timeout_sec, Blacklist blacklist, unsigned max_sessions) {
+    auto policy = std::make_unique<Policy>();
+    policy->blacklist = std::move(blacklist);
+    policy->max_sessions = max_sessions;
+    policy->session_timeout = seconds(timeout_sec);
+    return policy;
+}
+
+// сообщения о каждой сессии - с ограничением частоты, итог по истечению
+// выводится отдельной строкой в expire_sessions()
+LogSampler g_session_log("Session events");
+LogSampler g_reject_log("Session limit", spdlog::level::warn);
+LogSampler g_expiry_log("Session expiry");
+
+} // namespace
+
 SessionManager::SessionManager(unsigned timeout_sec, 
                                const std::set<std::string>& blacklist,
-                               unsigned max_sessions)
-    : session_timeout_(timeout_sec),
-      blacklist_(blacklist),
-      max_sessions_(max_sessions) {
+                               unsigned max_sessions,
+                               unsigned shards)
+    : SessionManager(timeout_sec, Blacklist(blacklist), max_sessions, shards) {}
+
+SessionManager::SessionManager(unsigned timeout_sec, 
+                               Blacklist blacklist,
+                               unsigned max_sessions,
+                               unsigned shards)
+    : SessionManager(policy_of(timeout_sec, std::move(blacklist), max_sessions), shards) {}
+
+SessionManager::SessionManager(std::unique_ptr<const Policy> policy, unsigned shards)
+    : policy_owner_(std::move(policy)),
+      policy_(policy_owner_.get()),
+      table_limit_(policy_owner_->max_sessions),
+      shard_mask_(shard_count(shards) - 1),
+      shards_(std::make_unique<Shard[]>(shard_mask_ + 1)) {
+    
+    // вся память под сессии выделяется здесь, на горячем пути аллокаций нет
+    const size_t capacity = shard_capacity(table_limit_, shard_mask_ + 1);
+    for (size_t i = 0; i <= shard_mask_; ++i) {
+        shards_[i].table = SessionTable(capacity);
+    }
+    
+    spdlog::debug("SessionManager initialized with timeout: {}s, max sessions: {}, shards: {} x {} slots", 
+                  policy_owner_->session_timeout.count(), table_limit_, shard_mask_ + 1,
+                  shards_[0].table.capacity());
+}
+
+void SessionManager::set_policy(std::unique_ptr<const Policy> policy) {
+    std::lock_guard lock(policy_mutex_);
+    if (policy->max_sessions > table_limit_) {
+        spdlog::warn("max_sessions {} больше емкости таблиц сессий, действует {} (нужен перезапуск)",
+                     policy->max_sessions, table_limit_);
+    }
+    
+    std::shared_ptr<const Policy> retired = std::move(policy_owner_);
+    policy_owner_ = std::move(policy);
+    policy_.store(policy_owner_.get(), std::memory_order_release);
+    
+    // период ожидания: горячий путь читает указатель только под блокировкой
+    // сегмента, поэтому после прохода по всем сегментам старую политику
+    // никто не читает. снимки policy() держат ее сами
+    for (size_t i = 0; i <= shard_mask_; ++i) {
+        std::lock_guard shard_lock(shards_[i].mutex);
+    }
+    retired.reset();
     
-    spdlog::debug("SessionManager initialized with timeout: {}s, max sessions: {}", 
-                  timeout_sec, max_sessions);
+    spdlog::info("Политика обновлена: max_sessions {}, таймаут {} с, черный список {} IMSI / {} префиксов / {} диапазонов",
+                 policy_owner_->max_sessions, policy_owner_->session_timeout.count(),
+                 policy_owner_->blacklist.exact_count(), policy_owner_->blacklist.prefix_count(),
+                 policy_owner_->blacklist.range_count());
+}
+
+std::shared_ptr<const Policy> SessionManager::policy() const {
+    std::lock_guard lock(policy_mutex_);
+    return policy_owner_;
+}
+
+size_t SessionManager::shard_index(Imsi imsi) const {
+    // сегмент выбираем по старшим битам хеша, чтобы они не совпадали
+    // с младшими, по которым таблица внутри сегмента выбирает слот
+    const uint64_t hash = std::hash<Imsi>{}(imsi);
+    return (hash >> 32) & shard_mask_;
 }
 
-SessionManager::CreateResult SessionManager::try_create_session(const std::string& imsi) {
-    std::lock_guard lock(mutex_);
+SessionManager::Shard& SessionManager::shard_for(Imsi imsi) {
+    return shards_[shard_index(imsi)];
+}
+
+const SessionManager::Shard& SessionManager::shard_for(Imsi imsi) const {
+    return const_cast<SessionManager*>(this)->shard_for(imsi);
+}
+
+bool SessionManager::reserve_slot(const Policy& policy) {
+    const unsigned limit = std::min(policy.max_sessions, table_limit_);
+    unsigned current = session_count_.load(std::memory_order_relaxed);
+    do {
+        if (current >= limit) return false;
+    } while (!session_count_.compare_exchange_weak(current, current + 1,
+                                                   std::memory_order_relaxed));
+    return true;
+}
+
+SessionManager::CreateResult SessionManager::try_create_session(Imsi imsi) {
+    auto& shard = shard_for(imsi);
+    std::lock_guard lock(shard.mutex);
     
-    // проверка черного списка
-    if (blacklist_.find(imsi) != blacklist_.end()) {
-        spdlog::info("Session rejected (blacklist): {}", imsi);
+    // политику читаем под блокировкой сегмента, см. set_policy()
+    const Policy& policy = locked_policy();
+    if (policy.blacklist.contains(imsi)) {
+        if (g_session_log.allow()) spdlog::info("Session rejected (blacklist): {}", imsi);
         return CreateResult::REJECTED_BLACKLIST;
     }
     
-    // проверка существующей сессии
-    if (sessions_.find(imsi) != sessions_.end()) {
+    // существующая сессия: продлеваем
+    if (shard.table.touch(imsi, steady_clock::now())) {
+        journal(store_, SessionStore::Op::UPSERT, imsi);
         spdlog::debug("Session already exists: {}", imsi);
         return CreateResult::ALREADY_EXISTS;
     }
     
+    // идет graceful shutdown - новых сессий не создаем
+    if (!accepting()) {
+        spdlog::debug("Session rejected (draining): {}", imsi);
+        return CreateResult::REJECTED_LIMIT;
+    }
+    
     // проверка лимита сессий
-    if (sessions_.size() >= max_sessions_) {
-        spdlog::warn("Session limit reached ({}), rejecting: {}", max_sessions_, imsi);
+    if (!reserve_slot(policy)) {
+        if (g_reject_log.allow()) spdlog::warn("Session limit reached ({}), rejecting: {}", policy.max_sessions, imsi);
         return CreateResult::REJECTED_LIMIT;
     }
     
-    // создание новой сессии
-    sessions_[imsi] = Session{steady_clock::now()};
-    spdlog::info("Session created: {}", imsi);
+    // создание новой сессии, она же становится последней в очереди истечения
+    if (!shard.table.insert(imsi, steady_clock::now())) {
+        // сегмент заполнен сильнее расчетного - отказываем, а не расширяемся
+        session_count_.fetch_sub(1, std::memory_order_relaxed);
+        spdlog::warn("Session shard is full ({} slots), rejecting: {}",
+                     shard.table.capacity(), imsi);
+        return CreateResult::REJECTED_LIMIT;
+    }
+    journal(store_, SessionStore::Op::UPSERT, imsi);
+    if (g_session_log.allow()) spdlog::info("Session created: {}", imsi);
     return CreateResult::CREATED;
 }
 
-bool SessionManager::is_active(const std::string& imsi) const {
-    std::lock_guard lock(mutex_);
-    return sessions_.find(imsi) != sessions_.end();
+bool SessionManager::refresh_session(Imsi imsi) {
+    auto& shard = shard_for(imsi);
+    std::lock_guard lock(shard.mutex);
+    if (!shard.table.touch(imsi, steady_clock::now())) return false;
+    journal(store_, SessionStore::Op::UPSERT, imsi);
+    spdlog::debug("Session refreshed: {}", imsi);
+    return true;
 }
 
-void SessionManager::remove_session(const std::string& imsi) {
-    std::lock_guard lock(mutex_);
-    if (sessions_.erase(imsi) > 0) {
-        spdlog::info("Session removed: {}", imsi);
+bool SessionManager::is_active(Imsi imsi) const {
+    const auto& shard = shard_for(imsi);
+    std::lock_guard lock(shard.mutex);
+    return shard.table.contains(imsi);
+}
+
+std::vector<std::optional<steady_clock::time_point>>
+SessionManager::last_seen_batch(const std::vector<Imsi>& imsis) const {
+    std::vector<std::optional<steady_clock::time_point>> result(imsis.size());
+    
+    // (сегмент, позиция во входном списке), отсортировано по сегменту
+    std::vector<std::pair<size_t, size_t>> order(imsis.size());
+    for (size_t i = 0; i < imsis.size(); ++i) {
+        order[i] = {shard_index(imsis[i]), i};
     }
+    std::sort(order.begin(), order.end());
+    
+    for (size_t begin = 0; begin < order.size(); ) {
+        const size_t index = order[begin].first;
+        size_t end = begin;
+        const auto& shard = shards_[index];
+        std::lock_guard lock(shard.mutex);
+        for (; end < order.size() && order[end].first == index; ++end) {
+            result[order[end].second] = shard.table.last_seen(imsis[order[end].second]);
+        }
+        begin = end;
+    }
+    return result;
+}
+
+bool SessionManager::remove_session(Imsi imsi) {
+    auto& shard = shard_for(imsi);
+    std::lock_guard lock(shard.mutex);
+    if (!shard.table.erase(imsi)) return false;
+    journal(store_, SessionStore::Op::REMOVE, imsi);
+    session_count_.fetch_sub(1, std::memory_order_relaxed);
+    if (g_session_log.allow()) spdlog::info("Session removed: {}", imsi);
+    return true;
 }
 
 void SessionManager::remove_expired_sessions() {
+    expire_sessions(nullptr);
+}
+
+void SessionManager::remove_expired_sessions(CDRLogger& cdr_logger) {
+    expire_sessions(&cdr_logger);
+}
+
+void SessionManager::expire_sessions(CDRLogger* cdr_logger) {
     const auto now = steady_clock::now();
-    std::lock_guard lock(mutex_);
+    const auto timeout = policy()->session_timeout;
     
+    // блокируем сегменты по одному, остальные продолжают обслуживать запросы
     unsigned removed_count = 0;
-    for (auto it = sessions_.begin(); it != sessions_.end(); ) {
-        if (now - it->second.created_at > session_timeout_) {
-            spdlog::info("Session expired: {}", it->first);
-            it = sessions_.erase(it);
-            removed_count++;
-        } else {
-            ++it;
+    std::vector<Imsi> expired;
+    for (size_t i = 0; i <= shard_mask_; ++i) {
+        auto& shard = shards_[i];
+        {
+            std::lock_guard lock(shard.mutex);
+            
+            // снимаем сессии с головы очереди, пока они простаивают дольше таймаута
+            while (!shard.table.empty() &&
+                   now - shard.table.front_last_seen() > timeout) {
+                const Imsi imsi = shard.table.front();
+                shard.table.pop_front();
+                journal(store_, SessionStore::Op::REMOVE, imsi);
+                if (g_expiry_log.allow()) spdlog::info("Session expired: {}", imsi);
+                if (cdr_logger) expired.push_back(imsi);
+                session_count_.fetch_sub(1, std::memory_order_relaxed);
+                removed_count++;
+            }
+        }
+        
+        // CDR ставим в очередь уже без блокировки сегмента
+        for (Imsi imsi : expired) {
+            cdr_logger->log(imsi, CdrAction::EXPIRED);
         }
+        expired.clear();
     }
     
     if (removed_count > 0) {
+        Metrics::increment(Metric::SESSION_EXPIRED, removed_count);
         spdlog::info("Removed {} expired sessions", removed_count);
     }
 }
 
+std::optional<steady_clock::time_point> SessionManager::next_expiry() const {
+    std::optional<steady_clock::time_point> oldest;
+    for (size_t i = 0; i <= shard_mask_; ++i) {
+        const auto& shard = shards_[i];
+        std::lock_guard lock(shard.mutex);
+        if (!shard.table.empty() && (!oldest || shard.table.front_last_seen() < *oldest)) {
+            oldest = shard.table.front_last_seen();
+        }
+    }
+    if (!oldest) return std::nullopt;
+    return *oldest + policy()->session_timeout;
+}
+
 unsigned SessionManager::active_sessions() const {
-    std::lock_guard lock(mutex_);
-    return sessions_.size();
+    return session_count_.load(std::memory_order_relaxed);
 }
 
-void SessionManager::graceful_remove(const std::string& imsi, CDRLogger& cdr_logger) {
-    std::lock_guard lock(mutex_);
-    if (sessions_.erase(imsi) > 0) {
-        spdlog::info("Session gracefully removed: {}", imsi);
-        cdr_logger.log(imsi, "graceful_remove");
+void SessionManager::attach_store(SessionStore* store) {
+    store_.store(store, std::memory_order_release);
+}
+
+bool SessionManager::restore_session(Imsi imsi, steady_clock::time_point last_seen) {
+    auto& shard = shard_for(imsi);
+    std::lock_guard lock(shard.mutex);
+    
+    // черный список мог измениться между запусками
+    const Policy& policy = locked_policy();
+    if (policy.blacklist.contains(imsi)) return false;
+    if (shard.table.contains(imsi) || !reserve_slot(policy)) return false;
+    if (!shard.table.insert(imsi, last_seen)) {
+        session_count_.fetch_sub(1, std::memory_order_relaxed);
+        return false;
     }
+    return true;
+}
+
+void SessionManager::copy_shard(size_t index,
+                                std::vector<std::pair<Imsi, steady_clock::time_point>>& out) const {
+    const auto& shard = shards_[index & shard_mask_];
+    std::lock_guard lock(shard.mutex);
+    out.reserve(out.size() + shard.table.size());
+    shard.table.for_each([&](Imsi imsi, steady_clock::time_point last_seen) {
+        out.emplace_back(imsi, last_seen);
+        return true;
+    });
 }
 
-void SessionManager::graceful_shutdown(unsigned rate, CDRLogger& cdr_logger) {
-    spdlog::info("Graceful shutdown initiated, rate: {}", rate);
+void SessionManager::set_accepting(bool accepting) {
+    accepting_.store(accepting, std::memory_order_relaxed);
+    spdlog::info(accepting ? "Session manager accepts new sessions"
+                           : "Session manager stopped accepting new sessions");
+}
+
+size_t SessionManager::drain_batch(size_t max_count, CDRLogger& cdr_logger) {
+    std::vector<Imsi> removed;
+    removed.reserve(std::min<size_t>(max_count, 4096));
     
-    while (active_sessions() > 0) {
-        std::vector<std::string> sessions_to_remove;
+    // один проход по кругу, пачка каждого сегмента - за одну блокировку
+    for (size_t visited = 0; visited <= shard_mask_ && removed.size() < max_count; ++visited) {
+        auto& shard = shards_[drain_cursor_];
+        drain_cursor_ = (drain_cursor_ + 1) & shard_mask_;
         
-        // собираем сессии для удаления
-        {
-            std::lock_guard lock(mutex_);
-            unsigned count = 0;
-            for (auto it = sessions_.begin(); 
-                 it != sessions_.end() && count < rate; 
-                 ++it, ++count) 
-            {
-                sessions_to_remove.push_back(it->first);
-            }
+        std::lock_guard lock(shard.mutex);
+        while (!shard.table.empty() && removed.size() < max_count) {
+            const Imsi imsi = shard.table.front();
+            shard.table.pop_front();
+            journal(store_, SessionStore::Op::REMOVE, imsi);
+            session_count_.fetch_sub(1, std::memory_order_relaxed);
+            removed.push_back(imsi);
         }
-        
-        // удаляем сессии
-        for (const auto& imsi : sessions_to_remove) {
-            graceful_remove(imsi, cdr_logger);
-        }
-        
-        // ожидаем до следующей итерации
-        std::this_thread::sleep_for(std::chrono::seconds(1));
     }
     
-    spdlog::info("Все сессии удалены в рамках graceful shutdown");
+    // CDR ставим в очередь уже без блокировок
+    for (Imsi imsi : removed) {
+        spdlog::debug("Session gracefully removed: {}", imsi);
+        cdr_logger.log(imsi, CdrAction::GRACEFUL_REMOVE);
+    }
+    if (!removed.empty()) {
+        Metrics::increment(Metric::SESSION_GRACEFUL_REMOVED, removed.size());
+    }
+    return removed.size();
 }
 
-} // namespace pgw
\ No newline at end of file
+} // namespace pgw
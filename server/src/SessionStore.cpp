@@ -0,0 +1,371 @@
+#include "SessionStore.hpp"
+#include "MappedFile.hpp"
+#include "SessionManager.hpp"
+#include "TimestampCache.hpp"
+#include <spdlog/spdlog.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <filesystem>
+#include <stdexcept>
+#include <unordered_map>
+
+namespace pgw {
+
+namespace {
+
+constexpr size_t kSnapshotHeaderSize = 24;  // magic, поколение, число записей
+constexpr std::string_view kJournalPrefix = "journal.";
+
+void put_le(char* out, uint64_t value, size_t bytes) {
+    for (size_t i = 0; i < bytes; ++i) {
+        out[i] = static_cast<char>(value >> (8 * i));
+    }
+}
+
+uint64_t get_le(const char* in, size_t bytes) {
+    uint64_t value = 0;
+    for (size_t i = 0; i < bytes; ++i) {
+        value |= uint64_t(static_cast<uint8_t>(in[i])) << (8 * i);
+    }
+    return value;
+}
+
+int64_t wall_now_ms() {
+    return TimestampCache::coarse_now_ns() / 1000000;
+}
+
+bool write_all(int fd, const std::string& data) {
+    size_t offset = 0;
+    while (offset < data.size()) {
+        ssize_t n = ::write(fd, data.data() + offset, data.size() - offset);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        offset += n;
+    }
+    return true;
+}
+
+} // namespace
+
+SessionStore::SessionStore(SessionManager& session_manager, const SessionStoreOptions& options)
+    : session_manager_(session_manager),
+      options_(options),
+      queue_(options.queue_size) {
+    std::error_code ec;
+    std::filesystem::create_directories(options_.dir, ec);
+    if (ec) {
+        throw std::runtime_error("Не удалось создать каталог состояния " + options_.dir + ": " + ec.message());
+    }
+}
+
+SessionStore::~SessionStore() {
+    stop();
+    if (journal_fd_ >= 0) ::close(journal_fd_);
+}
+
+std::string SessionStore::snapshot_path() const {
+    return options_.dir + "/sessions.snap";
+}
+
+std::string SessionStore::journal_path(uint64_t generation) const {
+    return options_.dir + "/" + std::string(kJournalPrefix) + std::to_string(generation);
+}
+
+std::vector<uint64_t> SessionStore::journal_generations() const {
+    std::vector<uint64_t> generations;
+    std::error_code ec;
+    for (const auto& entry : std::filesystem::directory_iterator(options_.dir, ec)) {
+        const std::string name = entry.path().filename().string();
+        if (name.compare(0, kJournalPrefix.size(), kJournalPrefix) != 0) continue;
+        const std::string suffix = name.substr(kJournalPrefix.size());
+        if (suffix.empty() || suffix.find_first_not_of("0123456789") != std::string::npos) continue;
+        generations.push_back(std::stoull(suffix));
+    }
+    std::sort(generations.begin(), generations.end());
+    return generations;
+}
+
+size_t SessionStore::recover(std::chrono::seconds session_timeout) {
+    const auto started = std::chrono::steady_clock::now();
+
+    // IMSI -> время последней активности, мс от эпохи
+    std::unordered_map<uint64_t, int64_t> sessions;
+    uint64_t snapshot_generation = 0;
+
+    {
+        MappedFile file(snapshot_path());
+        const std::string_view data = file.view();
+        if (data.size() >= kSnapshotHeaderSize && data.substr(0, kSnapshotMagic.size()) == kSnapshotMagic) {
+            const uint64_t generation = get_le(data.data() + 8, 8);
+            const uint64_t count = get_le(data.data() + 16, 8);
+            if (data.size() == kSnapshotHeaderSize + count * kRecordSize) {
+                snapshot_generation = generation;
+                sessions.reserve(count);
+                for (uint64_t i = 0; i < count; ++i) {
+                    const char* p = data.data() + kSnapshotHeaderSize + i * kRecordSize;
+                    sessions[get_le(p, 8)] = static_cast<int64_t>(get_le(p + 8, 8));
+                }
+            } else {
+                spdlog::error("Снимок сессий поврежден ({} байт), используем только журналы", data.size());
+            }
+        } else if (!data.empty()) {
+            spdlog::error("Неизвестный формат снимка сессий {}", snapshot_path());
+        }
+    }
+
+    // журналы от поколения снимка: порядок внутри файла - порядок изменений.
+    // недописанная последняя запись (падение посреди write) отбрасывается
+    uint64_t last_generation = snapshot_generation;
+    size_t replayed = 0;
+    for (uint64_t generation : journal_generations()) {
+        last_generation = std::max(last_generation, generation);
+        if (generation < snapshot_generation) continue;
+
+        MappedFile file(journal_path(generation));
+        const std::string_view data = file.view();
+        if (data.size() < kJournalMagic.size() || data.substr(0, kJournalMagic.size()) != kJournalMagic) {
+            if (!data.empty()) spdlog::error("Журнал {} поврежден, пропущен", journal_path(generation));
+            continue;
+        }
+        const size_t records = (data.size() - kJournalMagic.size()) / kRecordSize;
+        for (size_t i = 0; i < records; ++i) {
+            const char* p = data.data() + kJournalMagic.size() + i * kRecordSize;
+            const uint64_t imsi = get_le(p, 8);
+            switch (static_cast<Op>(p[14])) {
+                case Op::UPSERT: sessions[imsi] = static_cast<int64_t>(get_le(p + 8, 6)); break;
+                case Op::REMOVE: sessions.erase(imsi); break;
+            }
+        }
+        replayed += records;
+    }
+    generation_ = last_generation;
+
+    // восстанавливаем от давних к свежим: так строится список истечения.
+    // время простоя переносится на steady_clock текущего запуска
+    std::vector<std::pair<int64_t, uint64_t>> ordered;
+    ordered.reserve(sessions.size());
+    for (const auto& [imsi, time_ms] : sessions) {
+        if (imsi == 0) continue;  // 0 - пустой слот таблицы, в файле это мусор
+        ordered.emplace_back(time_ms, imsi);
+    }
+    std::sort(ordered.begin(), ordered.end());
+
+    const int64_t now_ms = wall_now_ms();
+    const auto steady_now = std::chrono::steady_clock::now();
+    size_t restored = 0;
+    size_t expired = 0;
+    for (const auto& [time_ms, raw] : ordered) {
+        const auto idle = std::chrono::milliseconds(std::max<int64_t>(now_ms - time_ms, 0));
+        if (idle > session_timeout) {
+            expired++;
+            continue;
+        }
+        if (session_manager_.restore_session(Imsi::from_raw(raw), steady_now - idle)) restored++;
+    }
+
+    spdlog::info("Восстановлено {} сессий (снимок поколения {}, записей журнала {}, истекло {}) за {} мс",
+                 restored, snapshot_generation, replayed, expired,
+                 std::chrono::duration_cast<std::chrono::milliseconds>(
+                     std::chrono::steady_clock::now() - started).count());
+    return restored;
+}
+
+void SessionStore::start() {
+    if (running_) return;
+    // первый снимок сразу, он же открывает журнал: восстановленное
+    // состояние сворачивается, старые журналы удаляются. запросы еще
+    // не принимаются, поэтому подключаемся к менеджеру после снимка
+    snapshot();
+    session_manager_.attach_store(this);
+    running_ = true;
+    writer_ = std::thread(&SessionStore::writer_loop, this);
+    if (options_.snapshot_interval_sec > 0) {
+        snapshotter_ = std::thread(&SessionStore::snapshot_loop, this);
+    }
+}
+
+void SessionStore::stop() {
+    if (!running_) return;
+    // изменения после отключения попадут в финальный снимок
+    session_manager_.attach_store(nullptr);
+    {
+        // под wake_mutex_: поток снимков не пропустит пробуждение
+        std::lock_guard lock(wake_mutex_);
+        running_ = false;
+    }
+    wake_cv_.notify_one();
+    snapshot_cv_.notify_one();
+    if (snapshotter_.joinable()) {
+        snapshotter_.join();
+    }
+    if (writer_.joinable()) {
+        writer_.join();
+    }
+    snapshot();
+}
+
+void SessionStore::record(Op op, Imsi imsi) {
+    const Entry entry{imsi.raw(), wall_now_ms(), op};
+    while (!queue_.try_push(entry)) {
+        if (op != Op::REMOVE || !running_) {
+            dropped_.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        // удаление не теряем: ждем, пока поток журнала освободит место
+        wake_cv_.notify_one();
+        std::this_thread::yield();
+    }
+    if (queue_.size() > queue_.capacity() / 2) {
+        wake_cv_.notify_one();
+    }
+}
+
+void SessionStore::open_journal_locked(uint64_t generation) {
+    const std::string path = journal_path(generation);
+    const int fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_APPEND | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        // остаемся на старом журнале: восстановление его подхватит
+        spdlog::error("Не удалось открыть журнал сессий {}: {}", path, strerror(errno));
+        return;
+    }
+    if (!write_all(fd, std::string(kJournalMagic))) {
+        spdlog::error("Ошибка записи журнала сессий {}: {}", path, strerror(errno));
+    }
+    if (journal_fd_ >= 0) {
+        if (options_.fsync) fdatasync(journal_fd_);
+        ::close(journal_fd_);
+    }
+    journal_fd_ = fd;
+    generation_ = generation;
+}
+
+void SessionStore::drain_locked() {
+    Entry entry;
+    size_t count = 0;
+    buffer_.clear();
+    while (queue_.try_pop(entry)) {
+        char bytes[kRecordSize];
+        put_le(bytes, entry.imsi, 8);
+        put_le(bytes + 8, static_cast<uint64_t>(entry.time_ms), 6);
+        bytes[14] = static_cast<char>(entry.op);
+        bytes[15] = 0;
+        buffer_.append(bytes, sizeof(bytes));
+        count++;
+    }
+    if (count == 0 || journal_fd_ < 0) return;
+
+    if (!write_all(journal_fd_, buffer_)) {
+        spdlog::error("Ошибка записи журнала сессий: {}", strerror(errno));
+        return;
+    }
+    if (options_.fsync) fdatasync(journal_fd_);
+    journaled_.fetch_add(count, std::memory_order_relaxed);
+}
+
+bool SessionStore::write_snapshot(uint64_t generation) {
+    // согласованный вид каждого сегмента: копия под его блокировкой,
+    // остальные сегменты в это время обслуживают запросы
+    std::vector<std::pair<Imsi, std::chrono::steady_clock::time_point>> shard;
+    std::string data(kSnapshotHeaderSize, '\0');
+    std::memcpy(data.data(), kSnapshotMagic.data(), kSnapshotMagic.size());
+    put_le(data.data() + 8, generation, 8);
+
+    uint64_t count = 0;
+    for (size_t i = 0; i < session_manager_.shards(); ++i) {
+        shard.clear();
+        session_manager_.copy_shard(i, shard);
+
+        const int64_t now_ms = wall_now_ms();
+        const auto steady_now = std::chrono::steady_clock::now();
+        for (const auto& [imsi, last_seen] : shard) {
+            const auto idle = std::chrono::duration_cast<std::chrono::milliseconds>(steady_now - last_seen);
+            char bytes[kRecordSize];
+            put_le(bytes, imsi.raw(), 8);
+            put_le(bytes + 8, static_cast<uint64_t>(now_ms - idle.count()), 8);
+            data.append(bytes, sizeof(bytes));
+        }
+        count += shard.size();
+    }
+    put_le(data.data() + 16, count, 8);
+
+    // пишем во временный файл и атомарно подменяем снимок
+    const std::string tmp = snapshot_path() + ".tmp";
+    const int fd = ::open(tmp.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        spdlog::error("Не удалось создать снимок сессий {}: {}", tmp, strerror(errno));
+        return false;
+    }
+    const bool written = write_all(fd, data) && fdatasync(fd) == 0;
+    ::close(fd);
+    if (!written || ::rename(tmp.c_str(), snapshot_path().c_str()) != 0) {
+        spdlog::error("Ошибка записи снимка сессий: {}", strerror(errno));
+        ::unlink(tmp.c_str());
+        return false;
+    }
+
+    // журналы до поколения снимка больше не нужны
+    for (uint64_t old : journal_generations()) {
+        if (old < generation) ::unlink(journal_path(old).c_str());
+    }
+    spdlog::info("Снимок сессий записан: {} сессий, поколение {}", count, generation);
+    return true;
+}
+
+bool SessionStore::snapshot() {
+    std::lock_guard snapshot_lock(snapshot_mutex_);
+    const uint64_t generation = generation_ + 1;
+    {
+        // все, что уже в очереди, - в старый журнал; дальше пишем в новый,
+        // и только потом копируем сегменты
+        std::lock_guard lock(journal_mutex_);
+        drain_locked();
+        open_journal_locked(generation);
+        if (generation_ != generation) return false;
+    }
+    // копия сегментов, запись и fdatasync снимка - без блокировки журнала:
+    // поток журнала тем временем разбирает очередь в новое поколение
+    return write_snapshot(generation);
+}
+
+void SessionStore::writer_loop() {
+    const auto flush_interval = std::chrono::milliseconds(options_.flush_interval_ms);
+    uint64_t reported_drops = 0;
+
+    while (running_) {
+        {
+            std::unique_lock lock(wake_mutex_);
+            wake_cv_.wait_for(lock, flush_interval, [this] {
+                return !running_ || queue_.size() > queue_.capacity() / 2;
+            });
+        }
+        {
+            std::lock_guard lock(journal_mutex_);
+            drain_locked();
+        }
+
+        const uint64_t drops = dropped();
+        if (drops != reported_drops) {
+            spdlog::warn("Очередь журнала сессий переполнена, отброшено записей: {}", drops - reported_drops);
+            reported_drops = drops;
+        }
+    }
+}
+
+void SessionStore::snapshot_loop() {
+    const auto snapshot_interval = std::chrono::seconds(options_.snapshot_interval_sec);
+    for (;;) {
+        {
+            std::unique_lock lock(wake_mutex_);
+            if (snapshot_cv_.wait_for(lock, snapshot_interval, [this] { return !running_; })) return;
+        }
+        snapshot();
+    }
+}
+
+} // namespace pgw
@@ -0,0 +1,143 @@
+#include "SessionTable.hpp"
+#include <functional>
+#include <stdexcept>
+
+namespace pgw {
+
+SessionTable::SessionTable(size_t capacity) {
+    size_t rounded = 8;
+    while (rounded < capacity) rounded <<= 1;
+    if (rounded > kNil) {
+        throw std::invalid_argument("слишком большая таблица сессий");
+    }
+    slots_.assign(rounded, Slot{});
+    mask_ = rounded - 1;
+}
+
+size_t SessionTable::home(uint64_t key) const {
+    return std::hash<Imsi>{}(Imsi::from_raw(key)) & mask_;
+}
+
+size_t SessionTable::distance(size_t index, uint64_t key) const {
+    return (index - home(key)) & mask_;
+}
+
+uint32_t SessionTable::find(Imsi imsi) const {
+    if (slots_.empty()) return kNil;
+
+    const uint64_t key = imsi.raw();
+    size_t index = home(key);
+    for (size_t dist = 0; ; ++dist, index = (index + 1) & mask_) {
+        const Slot& slot = slots_[index];
+        if (slot.key == key) return static_cast<uint32_t>(index);
+        // пустой слот или более "бедная" запись: дальше ключа быть не может
+        if (slot.key == 0 || distance(index, slot.key) < dist) return kNil;
+    }
+}
+
+bool SessionTable::insert(Imsi imsi, Clock::time_point last_seen) {
+    // держим заполнение не выше 7/8, иначе цепочки проб резко растут
+    if (slots_.empty() || size_ >= capacity() - capacity() / 8) return false;
+
+    const uint64_t key = imsi.raw();
+    size_t pos = home(key);
+    for (size_t dist = 0; ; ++dist, pos = (pos + 1) & mask_) {
+        const Slot& slot = slots_[pos];
+        if (slot.key == 0) break;
+        if (slot.key == key) return false;
+        if (distance(pos, slot.key) < dist) break;  // место новой записи
+    }
+
+    // Robin Hood: записи кластера упорядочены по идеальной позиции,
+    // поэтому вставка - сдвиг хвоста кластера на один слот вправо
+    if (slots_[pos].key != 0) {
+        size_t empty = pos;
+        while (slots_[empty].key != 0) empty = (empty + 1) & mask_;
+        for (size_t i = empty; i != pos; i = (i - 1) & mask_) {
+            move_slot((i - 1) & mask_, i);
+        }
+    }
+
+    // новая запись становится хвостом списка истечения
+    slots_[pos] = Slot{key, last_seen.time_since_epoch().count(), kNil, kNil};
+    link_back(static_cast<uint32_t>(pos));
+    ++size_;
+    return true;
+}
+
+bool SessionTable::touch(Imsi imsi, Clock::time_point now) {
+    const uint32_t index = find(imsi);
+    if (index == kNil) return false;
+    slots_[index].last_seen = now.time_since_epoch().count();
+    if (index != tail_) {
+        unlink(index);
+        link_back(index);
+    }
+    return true;
+}
+
+void SessionTable::unlink(uint32_t index) {
+    const Slot& slot = slots_[index];
+    if (slot.prev != kNil) {
+        slots_[slot.prev].next = slot.next;
+    } else {
+        head_ = slot.next;
+    }
+    if (slot.next != kNil) {
+        slots_[slot.next].prev = slot.prev;
+    } else {
+        tail_ = slot.prev;
+    }
+}
+
+void SessionTable::link_back(uint32_t index) {
+    slots_[index].prev = tail_;
+    slots_[index].next = kNil;
+    if (tail_ != kNil) {
+        slots_[tail_].next = index;
+    } else {
+        head_ = index;
+    }
+    tail_ = index;
+}
+
+bool SessionTable::erase(Imsi imsi) {
+    const uint32_t index = find(imsi);
+    if (index == kNil) return false;
+    erase_at(index);
+    return true;
+}
+
+void SessionTable::move_slot(size_t from, size_t to) {
+    const Slot& slot = slots_[from];
+    const uint32_t index = static_cast<uint32_t>(to);
+    if (slot.prev != kNil) {
+        slots_[slot.prev].next = index;
+    } else {
+        head_ = index;
+    }
+    if (slot.next != kNil) {
+        slots_[slot.next].prev = index;
+    } else {
+        tail_ = index;
+    }
+    slots_[to] = slot;
+}
+
+void SessionTable::erase_at(uint32_t index) {
+    unlink(index);
+
+    // обратный сдвиг: подтягиваем следующие записи кластера,
+    // пока не встретим пустой слот или запись на своей идеальной позиции
+    size_t hole = index;
+    size_t next = (hole + 1) & mask_;
+    while (slots_[next].key != 0 && distance(next, slots_[next].key) > 0) {
+        move_slot(next, hole);
+        hole = next;
+        next = (next + 1) & mask_;
+    }
+    slots_[hole] = Slot{};
+    --size_;
+}
+
+} // namespace pgw
@@ -0,0 +1,41 @@
+#include "TimestampCache.hpp"
+#include <time.h>
+#include <ctime>
+
+namespace pgw {
+
+std::string_view TimestampCache::format(int64_t timestamp_ns) {
+    // деление с округлением вниз, чтобы время до эпохи тоже было корректным
+    int64_t second = timestamp_ns / 1000000000;
+    int64_t nanos = timestamp_ns % 1000000000;
+    if (nanos < 0) {
+        second -= 1;
+        nanos += 1000000000;
+    }
+    
+    if (second != cached_second_) {
+        const std::time_t seconds = static_cast<std::time_t>(second);
+        std::tm local{};
+        localtime_r(&seconds, &local);
+        std::strftime(text_, sizeof(text_), "%Y-%m-%d %H:%M:%S", &local);
+        cached_second_ = second;
+    }
+    if (!with_millis_) {
+        return std::string_view(text_, kSecondsLength);
+    }
+    
+    const unsigned millis = static_cast<unsigned>(nanos / 1000000);
+    text_[kSecondsLength] = '.';
+    text_[kSecondsLength + 1] = static_cast<char>('0' + millis / 100);
+    text_[kSecondsLength + 2] = static_cast<char>('0' + millis / 10 % 10);
+    text_[kSecondsLength + 3] = static_cast<char>('0' + millis % 10);
+    return std::string_view(text_, kSecondsLength + 4);
+}
+
+int64_t TimestampCache::coarse_now_ns() {
+    timespec ts{};
+    clock_gettime(CLOCK_REALTIME_COARSE, &ts);
+    return int64_t(ts.tv_sec) * 1000000000 + ts.tv_nsec;
+}
+
+} // namespace pgw
@@ -1,24 +1,86 @@
 #include "UdpServer.hpp"
+#include "Metrics.hpp"
+#include "Gtpv2.hpp"
+#include "LogSampler.hpp"
 #include <spdlog/spdlog.h>
 #include <unistd.h>
 #include <arpa/inet.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <array>
 #include <cstring>
 #include <stdexcept>
+#include <vector>
 
 namespace pgw {
 
-UdpServer::UdpServer(const std::string& ip, uint16_t port, 
+namespace {
+
+// самый большой бинарный запрос + байт, чтобы отличить слишком длинный пакет
+// (текстовому IMSI хватает 16 байт)
+constexpr size_t kDatagramBufferSize = kMaxRequestSize + 1;
+
+// вызовов recvfrom/recvmmsg на одно событие готовности: под непрерывной
+// нагрузкой цикл событий успевает заметить остановку
+constexpr unsigned kReceiveBudget = 64;
+
+// счетчик перезапусков для IE Recovery: состояние между запусками
+// не сохраняется, поэтому всегда 0
+constexpr uint8_t kGtpRestartCounter = 0;
+
+// сообщения на каждый пакет - с ограничением частоты
+LogSampler g_request_log("Получен запрос");
+LogSampler g_malformed_log("Некорректный запрос", spdlog::level::warn);
+
+void log_request(const sockaddr_in& client_addr, std::string_view payload) {
+    if (!g_request_log.allow()) return;
+    
+    // преобразуем IP клиента в читаемый вид, только если сообщение попадет в журнал
+    char client_ip[INET_ADDRSTRLEN];
+    inet_ntop(AF_INET, &client_addr.sin_addr, client_ip, sizeof(client_ip));
+    if (is_gtpv2_packet(payload)) {
+        spdlog::info("Получен GTPv2-C запрос от {}: {} байт", client_ip, payload.size());
+    } else if (is_binary_packet(payload)) {
+        spdlog::info("Получен бинарный запрос от {}: {} байт", client_ip, payload.size());
+    } else {
+        spdlog::info("Получен запрос от {}: IMSI={}", client_ip, payload);
+    }
+}
+
+} // namespace
+
+UdpServer::UdpServer(const std::string& ip, uint16_t port,
                      SessionManager& session_manager,
-                     CDRLogger& cdr_logger)
+                     CDRLogger& cdr_logger,
+                     unsigned batch_size,
+                     bool reuse_port,
+                     GtpTeidMap* teids,
+                     UdpBackend backend)
     : session_manager_(session_manager),
       cdr_logger_(cdr_logger),
-      running_(false) {
+      batch_size_(batch_size > 0 ? batch_size : 1),
+#ifdef PGW_WITH_IO_URING
+      backend_(backend),
+#else
+      backend_(UdpBackend::EPOLL),
+#endif
+      own_teids_(teids ? nullptr : std::make_unique<GtpTeidMap>()),
+      teids_(teids ? teids : own_teids_.get()) {
     
-    sockfd_ = socket(AF_INET, SOCK_DGRAM, 0);
+    sockfd_ = socket(AF_INET, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
     if (sockfd_ < 0) {
         throw std::runtime_error("ошибка создания сокета: " + std::string(strerror(errno)));
     }
     
+    if (reuse_port) {
+        // ядро распределяет датаграммы между сокетами воркеров по хешу адресов
+        int on = 1;
+        if (setsockopt(sockfd_, SOL_SOCKET, SO_REUSEPORT, &on, sizeof(on)) < 0) {
+            close(sockfd_);
+            throw std::runtime_error("ошибка установки SO_REUSEPORT: " + std::string(strerror(errno)));
+        }
+    }
+    
     addr_.sin_family = AF_INET;
     addr_.sin_port = htons(port);
     
@@ -38,97 +100,382 @@ UdpServer::UdpServer(const std::string& ip, uint16_t port,
     getsockname(sockfd_, (struct sockaddr*)&actual_addr, &len);
     addr_.sin_port = actual_addr.sin_port;  // сохраняем реальный порт
     
-    spdlog::info("UDP сервер создан на {}:{}", 
-                 inet_ntoa(addr_.sin_addr), ntohs(addr_.sin_port));
+#ifndef PGW_WITH_IO_URING
+    if (backend == UdpBackend::IO_URING) {
+        spdlog::warn("Сервер собран без PGW_WITH_IO_URING, UDP принимается через epoll");
+    }
+#endif
+    spdlog::info("UDP сервер создан на {}:{}, размер пакета {}",
+                 inet_ntoa(addr_.sin_addr), ntohs(addr_.sin_port), batch_size_);
 }
 
 uint16_t UdpServer::port() const {
     return ntohs(addr_.sin_port);
 }
 
-void UdpServer::handle_request(const std::string& imsi, const sockaddr_in& client_addr) {
+std::optional<UdpBackend> UdpServer::active_backend() const {
+    if (!started_.load(std::memory_order_acquire)) return std::nullopt;
+    return active_backend_;
+}
+
+void UdpServer::set_active_backend(UdpBackend backend) {
+    active_backend_ = backend;
+    started_.store(true, std::memory_order_release);
+}
+
+ResultCode UdpServer::create_session(Imsi imsi) {
     // обрабатываем запрос через менеджер сессий
     auto result = session_manager_.try_create_session(imsi);
     
-    std::string response;
-    std::string action;
+    ResultCode code;
+    CdrAction action;
     
-    // формируем ответ клиенту и действие для лога
+    // код результата и действие для лога
     switch(result) {
         case SessionManager::CreateResult::CREATED:
-            response = "created";
-            action = "created";
+            code = ResultCode::CREATED;
+            action = CdrAction::CREATED;
+            Metrics::increment(Metric::SESSION_CREATED);
             break;
         case SessionManager::CreateResult::ALREADY_EXISTS:
-            response = "created";
-            action = "exists";
+            code = ResultCode::EXISTS;
+            action = CdrAction::EXISTS;
+            Metrics::increment(Metric::SESSION_EXISTS);
+            break;
+        case SessionManager::CreateResult::REJECTED_BLACKLIST:
+            code = ResultCode::REJECTED_BLACKLIST;
+            action = CdrAction::REJECTED;
+            Metrics::increment(Metric::REJECTED_BLACKLIST);
             break;
         default:
-            response = "rejected";
-            action = "rejected";
+            code = ResultCode::REJECTED_LIMIT;
+            action = CdrAction::REJECTED;
+            Metrics::increment(Metric::REJECTED_LIMIT);
     }
     
-    // логируем действие в CDR
+    // ставим запись CDR в очередь, в файл ее запишет поток CDRLogger
     cdr_logger_.log(imsi, action);
+    return code;
+}
+
+ResultCode UdpServer::delete_session(Imsi imsi) {
+    if (!session_manager_.remove_session(imsi)) return ResultCode::NOT_FOUND;
+    Metrics::increment(Metric::SESSION_DELETED);
+    cdr_logger_.log(imsi, CdrAction::DELETED);
+    return ResultCode::DELETED;
+}
+
+ResultCode UdpServer::refresh_session(Imsi imsi) {
+    if (!session_manager_.refresh_session(imsi)) return ResultCode::NOT_FOUND;
+    Metrics::increment(Metric::SESSION_REFRESHED);
+    cdr_logger_.log(imsi, CdrAction::REFRESHED);
+    return ResultCode::REFRESHED;
+}
+
+ResultCode UdpServer::apply(PacketType request, Imsi imsi) {
+    switch (request) {
+        case PacketType::DELETE_REQUEST: return delete_session(imsi);
+        case PacketType::REFRESH_REQUEST: return refresh_session(imsi);
+        default: return create_session(imsi);
+    }
+}
+
+std::string_view UdpServer::process_binary(std::string_view payload, char* reply) {
+    auto header = decode_header(payload);
+    if (!header || !is_request(header->type)) {
+        if (g_malformed_log.allow()) spdlog::warn("Некорректный бинарный пакет ({} байт), отброшен", payload.size());
+        Metrics::increment(Metric::MALFORMED_PACKETS);
+        return {};
+    }
+    
+    // ответ: тот же seq и по байту результата на каждый IMSI
+    encode_header(reply, {response_type(header->type), header->count, header->seq});
+    const auto* items = reinterpret_cast<const uint8_t*>(payload.data() + kPacketHeaderSize);
+    for (size_t i = 0; i < header->count; ++i) {
+        auto imsi = Imsi::from_tbcd(items + i * Imsi::kTbcdSize, Imsi::kTbcdSize);
+        ResultCode code = ResultCode::INVALID_IMSI;
+        if (imsi) {
+            code = apply(header->type, *imsi);
+        } else {
+            Metrics::increment(Metric::REJECTED_INVALID);
+        }
+        reply[kPacketHeaderSize + i] = static_cast<char>(code);
+    }
+    return std::string_view(reply, kPacketHeaderSize + header->count);
+}
+
+std::string_view UdpServer::process_gtp(std::string_view payload, char* reply) {
+    auto message = GtpMessage::parse(payload);
+    if (!message) {
+        if (g_malformed_log.allow()) spdlog::warn("Некорректное GTPv2-C сообщение ({} байт), отброшено", payload.size());
+        Metrics::increment(Metric::MALFORMED_PACKETS);
+        return {};
+    }
+    
+    const uint32_t seq = message->sequence();
+    switch (static_cast<GtpMessageType>(message->type())) {
+        case GtpMessageType::ECHO_REQUEST: {
+            GtpWriter writer(reply, kMaxResponseSize, GtpMessageType::ECHO_RESPONSE, std::nullopt, seq);
+            writer.add_recovery(kGtpRestartCounter);
+            return writer.finish();
+        }
+        
+        case GtpMessageType::CREATE_SESSION_REQUEST: {
+            auto imsi = message->imsi();
+            auto peer_teid = message->fteid_teid(0);
+            // ответ адресуется TEID отправителя из его Sender F-TEID
+            GtpWriter writer(reply, kMaxResponseSize, GtpMessageType::CREATE_SESSION_RESPONSE,
+                             peer_teid.value_or(0), seq);
+            if (!imsi || !peer_teid) {
+                Metrics::increment(Metric::REJECTED_INVALID);
+                writer.add_cause(GtpCause::MANDATORY_IE_MISSING);
+                return writer.finish();
+            }
+            
+            switch (create_session(*imsi)) {
+                case ResultCode::CREATED:
+                case ResultCode::EXISTS: {
+                    const uint32_t teid = teids_->bind(*imsi, *peer_teid);
+                    writer.add_cause(GtpCause::REQUEST_ACCEPTED);
+                    writer.add_fteid(0, kFteidS5S8PgwGtpC, teid, addr_.sin_addr.s_addr);
+                    break;
+                }
+                case ResultCode::REJECTED_BLACKLIST:
+                    writer.add_cause(GtpCause::USER_AUTHENTICATION_FAILED);
+                    break;
+                default:
+                    writer.add_cause(GtpCause::NO_RESOURCES_AVAILABLE);
+            }
+            return writer.finish();
+        }
+        
+        case GtpMessageType::DELETE_SESSION_REQUEST: {
+            // сессию определяет TEID заголовка, выданный нами в Create Session Response
+            auto binding = message->has_teid() ? teids_->release(message->teid()) : std::nullopt;
+            GtpWriter writer(reply, kMaxResponseSize, GtpMessageType::DELETE_SESSION_RESPONSE,
+                             binding ? binding->peer_teid : 0, seq);
+            if (!binding || delete_session(binding->imsi) != ResultCode::DELETED) {
+                writer.add_cause(GtpCause::CONTEXT_NOT_FOUND);
+                return writer.finish();
+            }
+            writer.add_cause(GtpCause::REQUEST_ACCEPTED);
+            return writer.finish();
+        }
+        
+        default:
+            if (g_malformed_log.allow()) spdlog::warn("Неподдерживаемый тип GTPv2-C сообщения {}, отброшено", message->type());
+            Metrics::increment(Metric::MALFORMED_PACKETS);
+            return {};
+    }
+}
+
+std::string_view UdpServer::process_request(std::string_view payload, char* reply) {
+    const auto started = std::chrono::steady_clock::now();
+    
+    // первый байт отличает GTPv2-C и бинарный протокол от текстового
+    if (is_gtpv2_packet(payload)) {
+        auto response = process_gtp(payload, reply);
+        Metrics::observe_latency(std::chrono::steady_clock::now() - started);
+        return response;
+    }
+    if (is_binary_packet(payload)) {
+        auto response = process_binary(payload, reply);
+        Metrics::observe_latency(std::chrono::steady_clock::now() - started);
+        return response;
+    }
+    
+    // команда перед IMSI: "delete <IMSI>", "refresh <IMSI>", без нее - создание
+    PacketType request = PacketType::CREATE_REQUEST;
+    if (payload.substr(0, kTextDeleteCommand.size()) == kTextDeleteCommand) {
+        request = PacketType::DELETE_REQUEST;
+        payload.remove_prefix(kTextDeleteCommand.size());
+    } else if (payload.substr(0, kTextRefreshCommand.size()) == kTextRefreshCommand) {
+        request = PacketType::REFRESH_REQUEST;
+        payload.remove_prefix(kTextRefreshCommand.size());
+    }
+    
+    // разбираем IMSI без аллокаций: до 15 цифр упаковываются в 64 бита
+    auto imsi = Imsi::parse(payload);
+    if (!imsi) {
+        if (g_malformed_log.allow()) spdlog::warn("Некорректный IMSI в запросе: '{}'", payload);
+        Metrics::increment(Metric::REJECTED_INVALID);
+        return "rejected";
+    }
+    
+    // создание в текстовом протоколе различает только created/rejected
+    const ResultCode code = apply(request, *imsi);
+    Metrics::observe_latency(std::chrono::steady_clock::now() - started);
+    switch (code) {
+        case ResultCode::CREATED:
+        case ResultCode::EXISTS: return "created";
+        case ResultCode::DELETED:
+        case ResultCode::REFRESHED:
+        case ResultCode::NOT_FOUND: return to_string(code);
+        default: return "rejected";
+    }
+}
+
+std::string_view UdpServer::serve(std::string_view payload, const sockaddr_in& client_addr, char* reply) {
+    log_request(client_addr, payload);
+    return process_request(payload, reply);
+}
+
+void UdpServer::handle_request(std::string_view payload, const sockaddr_in& client_addr) {
+    char reply[kMaxResponseSize];
+    auto response = serve(payload, client_addr, reply);
+    if (response.empty()) return;
     
     // отправляем ответ клиенту
     ssize_t sent = sendto(sockfd_, response.data(), response.size(), 0,
                          (struct sockaddr*)&client_addr, sizeof(client_addr));
     
     if (sent < 0) {
-        spdlog::error("Ошибка отправки для IMSI {}: {}", imsi, strerror(errno));
+        Metrics::increment(Metric::SEND_ERRORS);
+        spdlog::error("Ошибка отправки ответа ({} байт): {}", response.size(), strerror(errno));
     } else {
-        spdlog::debug("Отправлено {} байт для IMSI {}: {}", sent, imsi, response);
+        spdlog::debug("Отправлено {} байт", sent);
     }
 }
 
+// буферы пакетного режима: выделяются один раз при запуске воркера
+struct UdpServer::BatchBuffers {
+    explicit BatchBuffers(unsigned n)
+        : buffers(n), reply_buffers(n), client_addrs(n), rx_iov(n), tx_iov(n), rx_msgs(n), tx_msgs(n) {
+        for (unsigned i = 0; i < n; ++i) {
+            rx_iov[i].iov_base = buffers[i].data();
+            rx_iov[i].iov_len = kDatagramBufferSize;
+            rx_msgs[i].msg_hdr = msghdr{};
+            rx_msgs[i].msg_hdr.msg_iov = &rx_iov[i];
+            rx_msgs[i].msg_hdr.msg_iovlen = 1;
+            rx_msgs[i].msg_hdr.msg_name = &client_addrs[i];
+            tx_msgs[i].msg_hdr = msghdr{};
+            tx_msgs[i].msg_hdr.msg_iov = &tx_iov[i];
+            tx_msgs[i].msg_hdr.msg_iovlen = 1;
+        }
+    }
+    
+    std::vector<std::array<char, kDatagramBufferSize>> buffers;
+    std::vector<std::array<char, kMaxResponseSize>> reply_buffers;
+    std::vector<sockaddr_in> client_addrs;
+    std::vector<iovec> rx_iov;
+    std::vector<iovec> tx_iov;
+    std::vector<mmsghdr> rx_msgs;
+    std::vector<mmsghdr> tx_msgs;
+};
+
 void UdpServer::run() {
-    running_ = true;
-    spdlog::info("Запуск UDP сервера...");
+#ifdef PGW_WITH_IO_URING
+    if (backend_ == UdpBackend::IO_URING && run_uring()) {
+        close(sockfd_);
+        spdlog::info("UDP сервер остановлен");
+        return;
+    }
+#endif
+    std::unique_ptr<BatchBuffers> batch;
+    if (batch_size_ > 1) {
+        spdlog::info("Запуск UDP сервера в пакетном режиме (до {} датаграмм за вызов)...", batch_size_);
+        batch = std::make_unique<BatchBuffers>(batch_size_);
+    } else {
+        spdlog::info("Запуск UDP сервера...");
+    }
+    set_active_backend(UdpBackend::EPOLL);
+    
+    reactor_.add(sockfd_, EPOLLIN, [this, &batch](uint32_t) {
+        if (batch) {
+            receive_batches(*batch);
+        } else {
+            receive_datagrams();
+        }
+    });
+    reactor_.run();
     
-    char buffer[16]; // IMSI (15 цифр + null)
+    close(sockfd_);
+    spdlog::info("UDP сервер остановлен");
+}
+
+void UdpServer::receive_datagrams() {
+    char buffer[kDatagramBufferSize];
     sockaddr_in client_addr;
-    socklen_t len = sizeof(client_addr);
     
-    while (running_) {
-        // ждем входящего запроса
+    for (unsigned i = 0; i < kReceiveBudget; ++i) {
+        socklen_t len = sizeof(client_addr);
         ssize_t n = recvfrom(sockfd_, buffer, sizeof(buffer), 0,
                             (struct sockaddr*)&client_addr, &len);
-        
-        if (n <= 0) {
-            if (running_) {
+        if (n < 0) {
+            if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) {
                 spdlog::warn("Ошибка при чтении из сокета: {}", strerror(errno));
             }
-            continue;
+            return;  // очередь сокета пуста
         }
-        
-        // преобразуем данные в строку (IMSI)
-        buffer[n] = '\0';
-        std::string imsi(buffer);
-        
-        // преобразуем IP клиента в читаемый вид
-        char client_ip[INET_ADDRSTRLEN];
-        inet_ntop(AF_INET, &client_addr.sin_addr, client_ip, sizeof(client_ip));
-        
-        spdlog::info("Получен запрос от {}: IMSI={}", client_ip, imsi);
-        
+        if (n == 0) continue;
+        Metrics::increment(Metric::UDP_RECEIVED);
+    
+        // данные датаграммы - IMSI в ASCII или бинарный пакет, без копирования
+        std::string_view payload(buffer, n);
+    
         // обрабатываем запрос
-        handle_request(imsi, client_addr);
+        handle_request(payload, client_addr);
     }
+}
+
+void UdpServer::receive_batches(BatchBuffers& batch) {
+    const unsigned n = batch_size_;
     
-    close(sockfd_);
-    spdlog::info("UDP сервер остановлен");
+    for (unsigned round = 0; round < kReceiveBudget; ++round) {
+        for (unsigned i = 0; i < n; ++i) {
+            batch.rx_msgs[i].msg_hdr.msg_namelen = sizeof(sockaddr_in);
+        }
+    
+        // забираем все, что уже пришло, не дожидаясь новых датаграмм
+        int received = recvmmsg(sockfd_, batch.rx_msgs.data(), n, 0, nullptr);
+        if (received < 0) {
+            if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) {
+                spdlog::warn("Ошибка при чтении из сокета: {}", strerror(errno));
+            }
+            return;
+        }
+        if (received == 0) return;
+        Metrics::increment(Metric::UDP_RECEIVED, received);
+    
+        // обрабатываем всю пачку и готовим ответы
+        unsigned replies = 0;
+        for (int i = 0; i < received; ++i) {
+            const unsigned len = batch.rx_msgs[i].msg_len;
+            if (len == 0) continue;
+    
+            std::string_view payload(batch.buffers[i].data(), len);
+            auto response = serve(payload, batch.client_addrs[i], batch.reply_buffers[i].data());
+            if (response.empty()) continue;
+            batch.tx_iov[replies].iov_base = const_cast<char*>(response.data());
+            batch.tx_iov[replies].iov_len = response.size();
+            batch.tx_msgs[replies].msg_hdr.msg_name = &batch.client_addrs[i];
+            batch.tx_msgs[replies].msg_hdr.msg_namelen = batch.rx_msgs[i].msg_hdr.msg_namelen;
+            ++replies;
+        }
+    
+        // отправляем все ответы одним sendmmsg (повторяем для неотправленного хвоста)
+        unsigned flushed = 0;
+        while (flushed < replies) {
+            int sent = sendmmsg(sockfd_, batch.tx_msgs.data() + flushed, replies - flushed, 0);
+            if (sent < 0) {
+                Metrics::increment(Metric::SEND_ERRORS, replies - flushed);
+                spdlog::error("Ошибка пакетной отправки {} ответов: {}",
+                              replies - flushed, strerror(errno));
+                break;
+            }
+            flushed += sent;
+        }
+        spdlog::debug("Обработано {} датаграмм, отправлено {} ответов", received, flushed);
+        
+        // неполная пачка - очередь сокета опустела
+        if (static_cast<unsigned>(received) < n) return;
+    }
 }
 
 void UdpServer::stop() {
-    running_ = false;
-    // создаем фиктивный запрос для выхода из блокировки recvfrom
-    sockaddr_in dummy_addr{};
-    dummy_addr.sin_family = AF_INET;
-    dummy_addr.sin_port = htons(port());
-    inet_pton(AF_INET, "127.0.0.1", &dummy_addr.sin_addr);
-    
-    sendto(sockfd_, "", 1, 0, (struct sockaddr*)&dummy_addr, sizeof(dummy_addr));
+    // будим epoll_wait воркера через eventfd; фиктивная датаграмма на свой
+    // порт не подходит для SO_REUSEPORT - ядро может доставить ее другому воркеру
+    reactor_.stop();
 }
 
 } // namespace pgw
\ No newline at end of file
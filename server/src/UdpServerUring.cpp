@@ -0,0 +1,291 @@
+#include "UdpServer.hpp"
+#include "Metrics.hpp"
+#include "LogSampler.hpp"
+#include <spdlog/spdlog.h>
+#include <liburing.h>
+#include <sys/epoll.h>
+#include <cerrno>
+#include <cstring>
+#include <vector>
+
+namespace pgw {
+
+namespace {
+
+// записей в кольце отправки и буферов приема (степени двойки). очередь
+// завершений ядро делает вдвое больше кольца - в нее помещаются завершения
+// всех буферов приема и слотов отправки сразу
+constexpr unsigned kRingEntries = 1024;
+constexpr unsigned kReceiveBuffers = 1024;
+constexpr int kBufferGroup = 0;
+
+// буфер приема: заголовок io_uring_recvmsg_out, адрес клиента и датаграмма
+// (самый большой запрос + байт, чтобы отличить слишком длинный пакет)
+constexpr size_t kReceiveBufferSize =
+    sizeof(io_uring_recvmsg_out) + sizeof(sockaddr_in) + kMaxRequestSize + 1;
+
+// user_data: операция в старших 32 битах, номер слота отправки в младших
+constexpr uint64_t kReceiveTag = 1ull << 32;
+constexpr uint64_t kSendTag = 2ull << 32;
+constexpr uint64_t kCancelTag = 3ull << 32;
+constexpr uint64_t kTagMask = ~0ull << 32;
+
+LogSampler g_uring_log("Ошибка io_uring", spdlog::level::warn);
+
+} // namespace
+
+// один многоразовый recvmsg выдает по CQE на датаграмму, буфер ядро берет
+// из кольца буферов само. ответы копятся в слотах отправки и уходят одним
+// io_uring_submit на пачку CQE. кольцо зарегистрировано в реакторе воркера:
+// его дескриптор готов к чтению, когда есть завершения, поэтому stop()
+// работает как в обычном цикле
+struct UdpServer::UringState {
+    struct SendSlot {
+        msghdr msg;
+        iovec iov;
+        sockaddr_in addr;
+        char reply[kMaxResponseSize];
+    };
+
+    explicit UringState(UdpServer& server) : server(server) {}
+
+    ~UringState() {
+        if (buffer_ring) io_uring_free_buf_ring(&ring, buffer_ring, kReceiveBuffers, kBufferGroup);
+        if (ring_ready) io_uring_queue_exit(&ring);
+    }
+
+    bool setup();
+    io_uring_sqe* next_sqe();
+    void arm_receive();
+    void complete();  // разбор готовых завершений и отправка ответов пачкой
+    void dispatch(const io_uring_cqe* cqe);
+    void on_receive(const io_uring_cqe* cqe);
+    void on_send(const io_uring_cqe* cqe);
+    void send(uint32_t index, const sockaddr_in& client_addr, std::string_view response);
+    void recycle(unsigned buffer_id);
+    void shutdown();
+
+    UdpServer& server;
+    io_uring ring{};
+    bool ring_ready = false;
+    io_uring_buf_ring* buffer_ring = nullptr;
+    std::vector<char> buffers;       // kReceiveBuffers по kReceiveBufferSize
+    unsigned recycled = 0;           // возвращено в кольцо буферов с прошлой публикации
+    msghdr receive_msg{};            // шаблон приема: только адрес клиента
+    bool receiving = false;          // многоразовый прием активен
+    bool stopping = false;
+    std::vector<SendSlot> slots;
+    std::vector<uint32_t> free_slots;
+};
+
+bool UdpServer::UringState::setup() {
+    int ret = io_uring_queue_init(kRingEntries, &ring, 0);
+    if (ret < 0) {
+        spdlog::warn("io_uring недоступен ({}), UDP принимается через epoll", strerror(-ret));
+        return false;
+    }
+    ring_ready = true;
+
+    // кольцо буферов - ядро 5.19+
+    buffer_ring = io_uring_setup_buf_ring(&ring, kReceiveBuffers, kBufferGroup, 0, &ret);
+    if (!buffer_ring) {
+        spdlog::warn("Кольцо буферов io_uring не поддерживается ({}), UDP принимается через epoll",
+                     strerror(-ret));
+        return false;
+    }
+    buffers.resize(static_cast<size_t>(kReceiveBuffers) * kReceiveBufferSize);
+    for (unsigned i = 0; i < kReceiveBuffers; ++i) recycle(i);
+    io_uring_buf_ring_advance(buffer_ring, recycled);
+    recycled = 0;
+
+    receive_msg.msg_namelen = sizeof(sockaddr_in);
+
+    slots.resize(kRingEntries);
+    free_slots.reserve(kRingEntries);
+    for (uint32_t i = 0; i < kRingEntries; ++i) {
+        SendSlot& slot = slots[i];
+        slot.msg = msghdr{};
+        slot.msg.msg_name = &slot.addr;
+        slot.msg.msg_namelen = sizeof(slot.addr);
+        slot.msg.msg_iov = &slot.iov;
+        slot.msg.msg_iovlen = 1;
+        free_slots.push_back(kRingEntries - 1 - i);
+    }
+
+    // многоразовый recvmsg - ядро 6.0+; старое ядро отклоняет его сразу
+    // при отправке, и его последнее завершение (без F_MORE) уже в очереди.
+    // перед ним могут лежать завершения с датаграммами - их не трогаем
+    arm_receive();
+    io_uring_submit(&ring);
+    unsigned head;
+    io_uring_cqe* cqe;
+    io_uring_for_each_cqe(&ring, head, cqe) {
+        if ((io_uring_cqe_get_data64(cqe) & kTagMask) != kReceiveTag ||
+            (cqe->flags & IORING_CQE_F_MORE)) {
+            continue;
+        }
+        if (cqe->res == -EINVAL) {
+            spdlog::warn("Многоразовый recvmsg io_uring не поддерживается ядром, UDP принимается через epoll");
+            return false;
+        }
+        break;  // прием завершился по другой причине - complete() запустит его заново
+    }
+    return true;
+}
+
+io_uring_sqe* UdpServer::UringState::next_sqe() {
+    io_uring_sqe* sqe = io_uring_get_sqe(&ring);
+    if (!sqe) {
+        // очередь отправки заполнена: передаем накопленное ядру
+        io_uring_submit(&ring);
+        sqe = io_uring_get_sqe(&ring);
+    }
+    return sqe;
+}
+
+void UdpServer::UringState::arm_receive() {
+    io_uring_sqe* sqe = next_sqe();
+    if (!sqe) return;  // повторим после следующей пачки завершений
+    io_uring_prep_recvmsg_multishot(sqe, server.sockfd_, &receive_msg, 0);
+    sqe->flags |= IOSQE_BUFFER_SELECT;
+    sqe->buf_group = kBufferGroup;
+    io_uring_sqe_set_data64(sqe, kReceiveTag);
+    receiving = true;
+}
+
+void UdpServer::UringState::recycle(unsigned buffer_id) {
+    io_uring_buf_ring_add(buffer_ring, &buffers[static_cast<size_t>(buffer_id) * kReceiveBufferSize],
+                          kReceiveBufferSize, buffer_id,
+                          io_uring_buf_ring_mask(kReceiveBuffers), recycled++);
+}
+
+void UdpServer::UringState::complete() {
+    // не больше размера очереди завершений за вызов: под непрерывной
+    // нагрузкой реактор успевает заметить остановку
+    unsigned head;
+    unsigned count = 0;
+    io_uring_cqe* cqe;
+    io_uring_for_each_cqe(&ring, head, cqe) {
+        dispatch(cqe);
+        if (++count == 2 * kRingEntries) break;
+    }
+    io_uring_cq_advance(&ring, count);
+
+    if (recycled > 0) {
+        io_uring_buf_ring_advance(buffer_ring, recycled);
+        recycled = 0;
+    }
+    // прием прекращается при нехватке буферов (-ENOBUFS) - буферы уже
+    // возвращены, запускаем заново
+    if (!receiving && !stopping) arm_receive();
+    io_uring_submit(&ring);
+}
+
+void UdpServer::UringState::dispatch(const io_uring_cqe* cqe) {
+    switch (io_uring_cqe_get_data64(cqe) & kTagMask) {
+        case kReceiveTag: on_receive(cqe); break;
+        case kSendTag: on_send(cqe); break;
+        default: break;  // отмена приема при остановке
+    }
+}
+
+void UdpServer::UringState::on_receive(const io_uring_cqe* cqe) {
+    if (!(cqe->flags & IORING_CQE_F_MORE)) receiving = false;
+    if (cqe->res < 0) {
+        if (cqe->res != -ENOBUFS && cqe->res != -ECANCELED && g_uring_log.allow()) {
+            spdlog::warn("Ошибка приема io_uring: {}", strerror(-cqe->res));
+        }
+        return;
+    }
+    if (!(cqe->flags & IORING_CQE_F_BUFFER)) return;
+
+    const unsigned buffer_id = cqe->flags >> IORING_CQE_BUFFER_SHIFT;
+    char* buffer = &buffers[static_cast<size_t>(buffer_id) * kReceiveBufferSize];
+    io_uring_recvmsg_out* out = io_uring_recvmsg_validate(buffer, cqe->res, &receive_msg);
+    const unsigned length = out ? io_uring_recvmsg_payload_length(out, cqe->res, &receive_msg) : 0;
+    if (length > 0 && !stopping) {
+        Metrics::increment(Metric::UDP_RECEIVED);
+
+        // данные датаграммы разбираются прямо в буфере приема; адрес
+        // и ответ нужны до завершения отправки - они в слоте
+        std::string_view payload(static_cast<const char*>(io_uring_recvmsg_payload(out, &receive_msg)), length);
+        sockaddr_in client_addr;
+        std::memcpy(&client_addr, io_uring_recvmsg_name(out), sizeof(client_addr));
+
+        if (free_slots.empty()) {
+            // все слоты в полете - отвечаем синхронно
+            server.handle_request(payload, client_addr);
+        } else {
+            const uint32_t index = free_slots.back();
+            SendSlot& slot = slots[index];
+            auto response = server.serve(payload, client_addr, slot.reply);
+            if (!response.empty()) send(index, client_addr, response);
+        }
+    }
+    recycle(buffer_id);
+}
+
+void UdpServer::UringState::send(uint32_t index, const sockaddr_in& client_addr, std::string_view response) {
+    io_uring_sqe* sqe = next_sqe();
+    if (!sqe) {
+        // ядро не разобрало очередь отправки - отвечаем синхронно
+        if (sendto(server.sockfd_, response.data(), response.size(), 0,
+                   reinterpret_cast<const sockaddr*>(&client_addr), sizeof(client_addr)) < 0) {
+            Metrics::increment(Metric::SEND_ERRORS);
+        }
+        return;
+    }
+    SendSlot& slot = slots[index];
+    free_slots.pop_back();
+    slot.addr = client_addr;
+    slot.iov.iov_base = const_cast<char*>(response.data());
+    slot.iov.iov_len = response.size();
+    io_uring_prep_sendmsg(sqe, server.sockfd_, &slot.msg, 0);
+    io_uring_sqe_set_data64(sqe, kSendTag | index);
+}
+
+void UdpServer::UringState::on_send(const io_uring_cqe* cqe) {
+    const uint32_t index = static_cast<uint32_t>(io_uring_cqe_get_data64(cqe));
+    free_slots.push_back(index);
+    if (cqe->res < 0) {
+        Metrics::increment(Metric::SEND_ERRORS);
+        spdlog::error("Ошибка отправки ответа ({} байт): {}", slots[index].iov.iov_len, strerror(-cqe->res));
+    } else {
+        spdlog::debug("Отправлено {} байт", cqe->res);
+    }
+}
+
+void UdpServer::UringState::shutdown() {
+    // до завершения приема и отправок ядро может писать в буферы и читать
+    // слоты - отменяем прием и дожидаемся всех завершений
+    stopping = true;
+    if (receiving) {
+        if (io_uring_sqe* sqe = next_sqe()) {
+            io_uring_prep_cancel64(sqe, kReceiveTag, 0);
+            io_uring_sqe_set_data64(sqe, kCancelTag);
+        }
+    }
+    io_uring_submit(&ring);
+    while (receiving || free_slots.size() < slots.size()) {
+        io_uring_cqe* cqe;
+        if (io_uring_wait_cqe(&ring, &cqe) < 0) break;
+        dispatch(cqe);
+        io_uring_cqe_seen(&ring, cqe);
+    }
+}
+
+bool UdpServer::run_uring() {
+    UringState state(*this);
+    if (!state.setup()) return false;
+    set_active_backend(UdpBackend::IO_URING);
+
+    spdlog::info("Запуск UDP сервера через io_uring ({} буферов приема)...", kReceiveBuffers);
+    reactor_.add(state.ring.ring_fd, EPOLLIN, [&state](uint32_t) { state.complete(); });
+    reactor_.run();
+    // обработчик ссылается на state - снимаем его до разрушения кольца
+    reactor_.remove(state.ring.ring_fd);
+    state.shutdown();
+    return true;
+}
+
+} // namespace pgw
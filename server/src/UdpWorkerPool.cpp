@@ -0,0 +1,88 @@
+#include "UdpWorkerPool.hpp"
+#include <spdlog/spdlog.h>
+#include <pthread.h>
+#include <sched.h>
+#include <cstring>
+
+namespace pgw {
+
+UdpWorkerPool::UdpWorkerPool(const std::string& ip, uint16_t port,
+                             unsigned workers,
+                             SessionManager& session_manager,
+                             CDRLogger& cdr_logger,
+                             unsigned batch_size,
+                             std::vector<int> cpu_affinity,
+                             GtpTeidMap* teids,
+                             UdpBackend backend)
+    : cpu_affinity_(std::move(cpu_affinity)) {
+    
+    if (workers == 0) workers = 1;
+    if (!teids) {
+        own_teids_ = std::make_unique<GtpTeidMap>();
+        teids = own_teids_.get();
+    }
+    const bool reuse_port = workers > 1;
+    
+    // первый воркер получает реальный порт (важно для port = 0),
+    // остальные привязываются к нему же
+    workers_.push_back(std::make_unique<UdpServer>(
+        ip, port, session_manager, cdr_logger, batch_size, reuse_port, teids, backend));
+    const uint16_t bound_port = workers_.front()->port();
+    
+    for (unsigned i = 1; i < workers; ++i) {
+        workers_.push_back(std::make_unique<UdpServer>(
+            ip, bound_port, session_manager, cdr_logger, batch_size, reuse_port, teids, backend));
+    }
+    
+    spdlog::info("Пул UDP воркеров: {} шт. на порту {}", workers, bound_port);
+}
+
+UdpWorkerPool::~UdpWorkerPool() {
+    stop();
+}
+
+void UdpWorkerPool::start() {
+    for (unsigned i = 0; i < workers_.size(); ++i) {
+        threads_.emplace_back([worker = workers_[i].get()] {
+            worker->run();
+        });
+        
+        if (cpu_affinity_.empty()) continue;
+        
+        // закрепляем воркер за ядром
+        const int cpu = cpu_affinity_[i % cpu_affinity_.size()];
+        cpu_set_t cpuset;
+        CPU_ZERO(&cpuset);
+        CPU_SET(cpu, &cpuset);
+        int rc = pthread_setaffinity_np(threads_.back().native_handle(), sizeof(cpuset), &cpuset);
+        if (rc != 0) {
+            spdlog::warn("Не удалось закрепить UDP воркер {} за CPU {}: {}", i, cpu, strerror(rc));
+        } else {
+            spdlog::debug("UDP воркер {} закреплен за CPU {}", i, cpu);
+        }
+    }
+}
+
+void UdpWorkerPool::stop() {
+    if (threads_.empty()) return;  // не запущен или уже остановлен
+    
+    for (auto& worker : workers_) {
+        worker->stop();
+    }
+    for (auto& thread : threads_) {
+        if (thread.joinable()) {
+            thread.join();
+        }
+    }
+    threads_.clear();
+}
+
+uint16_t UdpWorkerPool::port() const {
+    return workers_.front()->port();
+}
+
+unsigned UdpWorkerPool::size() const {
+    return workers_.size();
+}
+
+} // namespace pgw
@@ -0,0 +1,62 @@
+#include <iostream>
+#include <fstream>
+#include <string>
+#include "CdrRecord.hpp"
+
+// конвертер бинарных CDR файлов в CSV.
+// использование: pgw_cdr2csv <файл.cdr> [файл.cdr ...] > cdr.csv
+int main(int argc, char* argv[]) {
+    if (argc < 2) {
+        std::cerr << "Использование: " << argv[0] << " <бинарный_cdr> [...]\n";
+        return 1;
+    }
+    
+    std::ios::sync_with_stdio(false);
+    std::cout << pgw::kCdrCsvHeader;
+    
+    int status = 0;
+    std::string out;
+    pgw::TimestampCache timestamps;
+    for (int i = 1; i < argc; ++i) {
+        std::ifstream file(argv[i], std::ios::binary);
+        if (!file.is_open()) {
+            std::cerr << "Не удалось открыть файл: " << argv[i] << "\n";
+            status = 1;
+            continue;
+        }
+        
+        char magic[pgw::kCdrBinaryMagic.size()];
+        if (!file.read(magic, sizeof(magic)) ||
+            std::string_view(magic, sizeof(magic)) != pgw::kCdrBinaryMagic) {
+            std::cerr << "Не бинарный CDR файл: " << argv[i] << "\n";
+            status = 1;
+            continue;
+        }
+        
+        // читаем записи блоками и форматируем в общий буфер
+        char block[pgw::kCdrBinaryRecordSize * 4096];
+        size_t skipped = 0;
+        while (file.read(block, sizeof(block)) || file.gcount() > 0) {
+            const size_t records = file.gcount() / pgw::kCdrBinaryRecordSize;
+            for (size_t r = 0; r < records; ++r) {
+                auto record = pgw::decode_binary(block + r * pgw::kCdrBinaryRecordSize);
+                if (record) {
+                    pgw::append_csv(out, *record, timestamps);
+                } else {
+                    skipped++;
+                }
+            }
+            std::cout << out;
+            out.clear();
+            if (file.gcount() % pgw::kCdrBinaryRecordSize != 0) {
+                std::cerr << "Обрезанная запись в конце файла: " << argv[i] << "\n";
+                status = 1;
+            }
+        }
+        if (skipped > 0) {
+            std::cerr << "Пропущено поврежденных записей в " << argv[i] << ": " << skipped << "\n";
+            status = 1;
+        }
+    }
+    return status;
+}
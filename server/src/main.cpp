@@ -1,35 +1,38 @@
 #include <iostream>
 #include "Config.hpp"
 #include "Logger.hpp"
-#include "UdpServer.hpp"
+#include "LogSampler.hpp"
+#include "UdpWorkerPool.hpp"
 #include "SessionManager.hpp"
+#include "SessionStore.hpp"
 #include "CDRLogger.hpp"
 #include "HttpApi.hpp"
+#include "Policy.hpp"
+#include "Reactor.hpp"
 #include <spdlog/spdlog.h>
+#include <algorithm>
 #include <thread>
 #include <csignal>
 #include <memory>
 
 std::atomic<bool> shutdown_requested{false};
 
-void signal_handler(int signal) {
-    if (signal == SIGINT) {
-        spdlog::info("Получен сигнал SIGINT, завершаем работу...");
-        spdlog::default_logger()->flush(); 
-        shutdown_requested = true;
-    }
-}
-
 int main(int argc, char* argv[]) {
     if (argc < 2) {
         std::cerr << "Использование: " << argv[0] << " <путь_к_конфигу>\n";
         return 1;
     }
+    
+    // SIGINT и SIGHUP обрабатывает основной цикл через signalfd; блокируем
+    // их до создания любых потоков, чтобы маску унаследовали все
+    pgw::Reactor::block_signals({SIGINT, SIGHUP});
 
     // объявляем умные указатели для основных компонентов
     std::unique_ptr<pgw::SessionManager> session_manager;
+    std::unique_ptr<pgw::SessionStore> session_store;
     std::unique_ptr<pgw::CDRLogger> cdr_logger;
-    std::unique_ptr<pgw::UdpServer> udp_server;
+    std::unique_ptr<pgw::GtpTeidMap> gtp_teids;
+    std::unique_ptr<pgw::UdpWorkerPool> udp_workers;
     std::unique_ptr<pgw::HttpApi> http_api;
 
     try {
@@ -37,69 +40,168 @@ int main(int argc, char* argv[]) {
         auto config = pgw::load_server_config(argv[1]);
         
         // инициализация логгера
-        pgw::Logger::init(config.log_file, config.log_level);
+        pgw::LoggerOptions log_options;
+        log_options.async = config.log_async;
+        log_options.queue_size = config.log_queue_size;
+        log_options.block_when_full = config.log_overflow == pgw::OverflowPolicy::BLOCK;
+        log_options.flush_interval_sec = config.log_flush_interval_sec;
+        log_options.sample_per_sec = config.log_sample_per_sec;
+        pgw::Logger::init(config.log_file, config.log_level, log_options);
         spdlog::info("Конфигурация загружена");
         
-        // создаем менеджер сессий
-        std::set<std::string> blacklist(
-            config.blacklist.begin(), 
-            config.blacklist.end()
-        );
+        // создаем менеджер сессий; черный список - записи из конфига
+        // плюс внешний файл
         session_manager = std::make_unique<pgw::SessionManager>(
-            config.session_timeout_sec,
-            blacklist,
-            config.max_sessions
+            pgw::make_policy(config),
+            config.session_shards
         );
         
+        // восстанавливаем сессии после перезапуска и включаем журнал
+        // до приема запросов
+        if (!config.state_dir.empty()) {
+            pgw::SessionStoreOptions store_options;
+            store_options.dir = config.state_dir;
+            store_options.snapshot_interval_sec = config.snapshot_interval_sec;
+            store_options.fsync = config.journal_fsync;
+            session_store = std::make_unique<pgw::SessionStore>(*session_manager, store_options);
+            session_store->recover(std::chrono::seconds(config.session_timeout_sec));
+            session_store->start();
+        }
+        
         // инициализируем CDR логгер
-        cdr_logger = std::make_unique<pgw::CDRLogger>(config.cdr_file);
+        pgw::CdrOptions cdr_options;
+        cdr_options.queue_size = config.cdr_queue_size;
+        cdr_options.flush_interval_ms = config.cdr_flush_interval_ms;
+        cdr_options.fsync = config.cdr_fsync;
+        // терять записи биллинга можно только явно
+        cdr_options.block_when_full = config.cdr_overflow == pgw::OverflowPolicy::BLOCK;
+        cdr_options.format = config.cdr_format;
+        cdr_options.rotate_bytes = config.cdr_rotate_bytes;
+        cdr_options.rotate_interval_sec = config.cdr_rotate_interval_sec;
+        cdr_options.timestamp_millis = config.cdr_timestamp_millis;
+        cdr_logger = std::make_unique<pgw::CDRLogger>(config.cdr_file, cdr_options);
         spdlog::info("CDR логгер инициализирован, файл: {}", config.cdr_file);
         
-        // создаем UDP сервер
-        udp_server = std::make_unique<pgw::UdpServer>(
+        // таблица TEID GTPv2-C, общая для всех воркеров
+        gtp_teids = std::make_unique<pgw::GtpTeidMap>(config.session_shards, config.max_sessions);
+        
+        // создаем пул UDP воркеров
+        udp_workers = std::make_unique<pgw::UdpWorkerPool>(
             config.udp_ip,
             config.udp_port,
+            config.udp_workers,
             *session_manager,
-            *cdr_logger
+            *cdr_logger,
+            config.udp_batch_size,
+            config.udp_cpu_affinity,
+            gtp_teids.get(),
+            config.udp_backend
         );
         spdlog::info("Сервер готов к работе на порту {}", config.udp_port);
         
-        // создаем и запускаем HTTP API
+        // создаем и запускаем HTTP API; опрос API не должен отнимать
+        // ядра у UDP воркеров
+        for (int cpu : config.http_cpu_affinity) {
+            if (std::find(config.udp_cpu_affinity.begin(), config.udp_cpu_affinity.end(), cpu)
+                    != config.udp_cpu_affinity.end()) {
+                spdlog::warn("CPU {} указан и в udp_cpu_affinity, и в http_cpu_affinity", cpu);
+            }
+        }
+        pgw::HttpOptions http_options;
+        http_options.threads = config.http_threads;
+        http_options.keep_alive_max_count = config.http_keep_alive_max_count;
+        http_options.keep_alive_timeout_sec = config.http_keep_alive_timeout_sec;
+        http_options.read_timeout_ms = config.http_read_timeout_ms;
+        http_options.write_timeout_ms = config.http_write_timeout_ms;
+        http_options.cpu_affinity = config.http_cpu_affinity;
         http_api = std::make_unique<pgw::HttpApi>(
             config.http_port,
             *session_manager,
             *cdr_logger,
             shutdown_requested,
-            config.graceful_shutdown_rate
+            config.graceful_shutdown_rate,
+            http_options
         );
-        http_api->run();
-        spdlog::info("HTTP API доступен на порту {}", config.http_port);
+        // основной цикл событий: таймеры, сигналы и остановка без опроса,
+        // без событий поток спит в epoll_wait
+        pgw::Reactor reactor;
+        const auto expiry_tick = std::chrono::milliseconds(std::max(config.expiry_tick_ms, 1u));
         
-        // обработка сигналов для graceful shutdown
-        std::signal(SIGINT, signal_handler);
+        // очистка истекших сессий к моменту ближайшего истечения, но не чаще
+        // expiry_tick. без сессий ждем полный таймаут: новая сессия истечет
+        // не раньше, чем через него
+        pgw::Reactor::TimerId expiry_timer = reactor.add_timer([&] {
+            session_manager->remove_expired_sessions(*cdr_logger);
+            const auto now = std::chrono::steady_clock::now();
+            const auto next = session_manager->next_expiry();
+            const auto delay = next ? std::chrono::duration_cast<std::chrono::nanoseconds>(*next - now)
+                                    : std::chrono::nanoseconds(session_manager->session_timeout());
+            reactor.arm_timer(expiry_timer, std::max<std::chrono::nanoseconds>(delay, expiry_tick));
+        });
+        reactor.arm_timer(expiry_timer, expiry_tick);
         
-        // запускаем UDP сервер в отдельном потоке
-        std::thread server_thread([&udp_server] {
-            udp_server->run();
+        // сводки по сообщениям, подавленным ограничением частоты
+        auto report_timer = reactor.add_timer([] { pgw::LogSampler::report_all(); });
+        reactor.arm_timer(report_timer, std::chrono::seconds(1), std::chrono::seconds(1));
+        
+        // привязки TEID истекших сессий обходят всю таблицу - реже
+        auto prune_timer = reactor.add_timer([&] {
+            size_t pruned = gtp_teids->prune(*session_manager);
+            if (pruned > 0) spdlog::debug("Удалено {} привязок TEID истекших сессий", pruned);
         });
+        reactor.arm_timer(prune_timer, std::chrono::seconds(60), std::chrono::seconds(60));
         
-        spdlog::info("Сервер запущен. Для остановки нажмите Ctrl+C");
+        // перезагрузка политики (черный список и лимиты) без перезапуска:
+        // по SIGHUP из основного цикла и через /reload из потока HTTP
+        // таймаут мог сократиться - ближайшую очистку пересчитываем в потоке
+        // цикла: там же ее перевзводит таймер очистки, и старый срок не
+        // перезапишет новый. reload_policy вызывается и из потока HTTP
+        auto rearm_timer = reactor.add_timer([&] { reactor.arm_timer(expiry_timer, expiry_tick); });
+        const std::string config_path = argv[1];
+        auto reload_policy = [&session_manager, &reactor, rearm_timer, config_path] {
+            const auto fresh = pgw::load_server_config(config_path);
+            session_manager->set_policy(pgw::make_policy(fresh));
+            reactor.arm_timer(rearm_timer, std::chrono::nanoseconds(1));
+        };
+        reactor.add_signals({SIGINT, SIGHUP}, [&](int signal) {
+            if (signal == SIGINT) {
+                spdlog::info("Получен сигнал SIGINT, завершаем работу...");
+                reactor.stop();
+                return;
+            }
+            spdlog::info("Получен сигнал SIGHUP, перечитываем {}", config_path);
+            try {
+                reload_policy();
+            } catch (const std::exception& e) {
+                // ошибка в новом конфиге не должна останавливать сервер
+                spdlog::error("Перезагрузка конфигурации не удалась, действует прежняя: {}", e.what());
+            }
+        });
         
-        // основной цикл обработки событий
-        while (!shutdown_requested) {
-            // периодическая очистка устаревших сессий
-            session_manager->remove_expired_sessions();
-            std::this_thread::sleep_for(std::chrono::seconds(5));
-        }
+        http_api->set_reload_handler(reload_policy);
+        // /stop по окончании удаления сессий сразу будит основной цикл
+        http_api->set_shutdown_handler([&reactor] { reactor.stop(); });
+        http_api->run();
+        spdlog::info("HTTP API доступен на порту {}", config.http_port);
+        
+        // запускаем UDP воркеры, каждый в своем потоке
+        udp_workers->start();
+        
+        spdlog::info("Сервер запущен. Для остановки нажмите Ctrl+C");
+        reactor.run();
         
         // остановка серверов
-        spdlog::info("Останавливаем UDP сервер...");
-        udp_server->stop();
-        server_thread.join();
+        spdlog::info("Останавливаем UDP воркеры...");
+        udp_workers->stop();
 
         spdlog::info("Останавливаем HTTP сервер...");
         http_api->stop();
         
+        // финальный снимок: следующий запуск поднимет сессии из него
+        if (session_store) {
+            session_store->stop();
+        }
+        
         spdlog::info("Сервер остановлен корректно");
     } catch (const std::exception& e) {
         spdlog::critical("Критическая ошибка: {}", e.what());
@@ -0,0 +1,83 @@
+#pragma once
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <atomic>
+#include <cstring>
+#include <functional>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+#include "Protocol.hpp"
+
+// UDP сервер-заглушка для тестов клиента: на каждую датаграмму вызывает
+// обработчик с номером попытки (сколько раз пришла та же датаграмма) и
+// отправляет все, что он вернул - пустой список теряет запрос, два ответа
+// дублируют его
+class UdpStub {
+public:
+    using Handler = std::function<std::vector<std::string>(std::string_view request, unsigned attempt)>;
+
+    explicit UdpStub(Handler handler) : handler_(std::move(handler)) {
+        fd_ = socket(AF_INET, SOCK_DGRAM | SOCK_CLOEXEC, 0);
+        if (fd_ < 0) {
+            throw std::runtime_error("ошибка создания сокета: " + std::string(strerror(errno)));
+        }
+        sockaddr_in addr{};
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        socklen_t len = sizeof(addr);
+        if (bind(fd_, reinterpret_cast<sockaddr*>(&addr), len) < 0 ||
+            getsockname(fd_, reinterpret_cast<sockaddr*>(&addr), &len) < 0) {
+            close(fd_);
+            throw std::runtime_error("ошибка bind: " + std::string(strerror(errno)));
+        }
+        port_ = ntohs(addr.sin_port);
+        thread_ = std::thread([this] { serve(); });
+    }
+
+    ~UdpStub() {
+        stopping_ = true;
+        thread_.join();
+        close(fd_);
+    }
+
+    uint16_t port() const { return port_; }
+
+    // всего принято датаграмм
+    uint64_t received() const { return received_.load(); }
+
+private:
+    void serve() {
+        char buffer[pgw::kMaxRequestSize];
+        while (!stopping_) {
+            pollfd pfd{fd_, POLLIN, 0};
+            if (poll(&pfd, 1, 10) <= 0) continue;
+
+            sockaddr_in client{};
+            socklen_t len = sizeof(client);
+            ssize_t n = recvfrom(fd_, buffer, sizeof(buffer), 0, reinterpret_cast<sockaddr*>(&client), &len);
+            if (n < 0) continue;
+
+            received_++;
+            const std::string request(buffer, n);
+            const unsigned attempt = ++attempts_[request];
+            for (const auto& response : handler_(request, attempt)) {
+                sendto(fd_, response.data(), response.size(), 0, reinterpret_cast<sockaddr*>(&client), len);
+            }
+        }
+    }
+
+    Handler handler_;
+    int fd_ = -1;
+    uint16_t port_ = 0;
+    std::atomic<bool> stopping_{false};
+    std::atomic<uint64_t> received_{0};
+    std::map<std::string, unsigned> attempts_;  // только поток заглушки
+    std::thread thread_;
+};
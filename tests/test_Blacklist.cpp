@@ -0,0 +1,84 @@
+#include <gtest/gtest.h>
+#include <cstdio>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "Blacklist.hpp"
+
+TEST(BlacklistTest, ExactPrefixAndRange) {
+    pgw::Blacklist blacklist(std::vector<std::string>{
+        "001010123456789",
+        "25001*",
+        "310260000000000-310260000000999",
+    });
+    EXPECT_EQ(blacklist.exact_count(), 1u);
+    EXPECT_EQ(blacklist.prefix_count(), 1u);
+    EXPECT_EQ(blacklist.range_count(), 1u);
+    
+    EXPECT_TRUE(blacklist.contains("001010123456789"));
+    EXPECT_FALSE(blacklist.contains("001010123456788"));
+    // точная запись не действует как префикс
+    EXPECT_FALSE(blacklist.contains("00101012345678"));
+    
+    EXPECT_TRUE(blacklist.contains("250010000000001"));
+    EXPECT_TRUE(blacklist.contains("25001"));
+    EXPECT_FALSE(blacklist.contains("2500"));
+    EXPECT_FALSE(blacklist.contains("250020000000001"));
+    
+    EXPECT_TRUE(blacklist.contains("310260000000000"));
+    EXPECT_TRUE(blacklist.contains("310260000000999"));
+    EXPECT_FALSE(blacklist.contains("310260000001000"));
+    EXPECT_FALSE(blacklist.contains("310259999999999"));
+    
+    EXPECT_FALSE(pgw::Blacklist().contains("001010123456789"));
+    EXPECT_THROW(pgw::Blacklist(std::vector<std::string>{"12a45"}), std::invalid_argument);
+    EXPECT_THROW(pgw::Blacklist(std::vector<std::string>{"*"}), std::invalid_argument);
+    EXPECT_THROW(pgw::Blacklist(std::vector<std::string>{"2-1"}), std::invalid_argument);
+}
+
+TEST(BlacklistTest, OverlappingRangesAreMerged) {
+    pgw::Blacklist blacklist(std::vector<std::string>{
+        "100000000000000-100000000000500",
+        "100000000000400-100000000000900",
+        "100000000000100-100000000000200",
+    });
+    EXPECT_EQ(blacklist.range_count(), 1u);
+    EXPECT_TRUE(blacklist.contains("100000000000700"));
+    EXPECT_FALSE(blacklist.contains("100000000000901"));
+}
+
+TEST(BlacklistTest, LoadFileInParallel) {
+    char path[] = "/tmp/pgw_blacklist_XXXXXX";
+    int fd = mkstemp(path);
+    ASSERT_NE(fd, -1);
+    close(fd);
+    {
+        std::ofstream file(path);
+        file << "# черный список\n\n";
+        for (int i = 0; i < 100000; ++i) {
+            file << "00101" << (1000000000 + 2 * i) << "\r\n";
+        }
+        file << "46000*\n"
+             << "not an imsi\n"
+             << "  001019999999999  \n"
+             << "001018888888888";  // без перевода строки в конце
+    }
+    
+    pgw::Blacklist blacklist;
+    EXPECT_EQ(blacklist.load_file(path, 4), 100003u);
+    blacklist.build();
+    EXPECT_EQ(blacklist.exact_count(), 100002u);
+    
+    // все записи найдены, соседние IMSI - нет
+    for (int i = 0; i < 100000; ++i) {
+        ASSERT_TRUE(blacklist.contains("00101" + std::to_string(1000000000 + 2 * i))) << i;
+        ASSERT_FALSE(blacklist.contains("00101" + std::to_string(1000000001 + 2 * i))) << i;
+    }
+    EXPECT_TRUE(blacklist.contains("460001234567890"));
+    EXPECT_TRUE(blacklist.contains("001019999999999"));
+    EXPECT_TRUE(blacklist.contains("001018888888888"));
+    std::remove(path);
+    
+    EXPECT_THROW(blacklist.load_file("/nonexistent/blacklist.txt"), std::runtime_error);
+}
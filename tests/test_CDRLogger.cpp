@@ -0,0 +1,213 @@
+#include "gtest/gtest.h"
+#include "CDRLogger.hpp"
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include <csignal>
+#include <sys/resource.h>
+#include <unistd.h>
+
+class CDRLoggerTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        char tmp_file[] = "/tmp/pgw_cdr_XXXXXX";
+        int fd = mkstemp(tmp_file);
+        if (fd == -1) {
+            throw std::runtime_error("не удалось создать временный файл");
+        }
+        close(fd);
+        cdr_file = tmp_file;
+    }
+    
+    void TearDown() override {
+        std::remove(cdr_file.c_str());
+    }
+    
+    std::vector<std::string> read_lines() {
+        std::ifstream file(cdr_file);
+        std::vector<std::string> lines;
+        for (std::string line; std::getline(file, line); ) {
+            lines.push_back(line);
+        }
+        return lines;
+    }
+    
+    std::string cdr_file;
+};
+
+TEST_F(CDRLoggerTest, WritesHeaderAndRecords) {
+    pgw::CDRLogger logger(cdr_file);
+    logger.log(pgw::Imsi("001010123456780"), pgw::CdrAction::CREATED);
+    logger.log(pgw::Imsi("001010123456789"), pgw::CdrAction::REJECTED);
+    logger.flush();
+    
+    auto lines = read_lines();
+    ASSERT_EQ(lines.size(), 3u);
+    EXPECT_EQ(lines[0], "timestamp,imsi,action");
+    // формат времени: YYYY-MM-DD HH:MM:SS
+    EXPECT_EQ(lines[1].size(), 19 + std::string(",001010123456780,created").size());
+    EXPECT_NE(lines[1].find(",001010123456780,created"), std::string::npos);
+    EXPECT_NE(lines[2].find(",001010123456789,rejected"), std::string::npos);
+    EXPECT_EQ(logger.written(), 2u);
+}
+
+TEST_F(CDRLoggerTest, ConcurrentProducers) {
+    {
+        pgw::CDRLogger logger(cdr_file);
+        std::vector<std::thread> threads;
+        for (int t = 0; t < 4; ++t) {
+            threads.emplace_back([&logger, t] {
+                for (int i = 0; i < 5000; ++i) {
+                    logger.log(pgw::Imsi(std::to_string(100000 + t * 10000 + i)), pgw::CdrAction::EXISTS);
+                }
+            });
+        }
+        for (auto& thread : threads) {
+            thread.join();
+        }
+        // деструктор дописывает остаток очереди
+        EXPECT_EQ(logger.dropped(), 0u);
+    }
+    EXPECT_EQ(read_lines().size(), 1u + 4 * 5000);
+}
+
+TEST_F(CDRLoggerTest, DropsWhenQueueIsFull) {
+    pgw::CdrOptions options;
+    options.queue_size = 4;
+    options.flush_interval_ms = 1000;
+    options.block_when_full = false;
+    pgw::CDRLogger logger(cdr_file, options);
+    
+    for (int i = 0; i < 10000; ++i) {
+        logger.log(pgw::Imsi("111111"), pgw::CdrAction::CREATED);
+    }
+    logger.flush();
+    
+    // каждая запись либо записана, либо учтена как потерянная
+    EXPECT_GT(logger.dropped(), 0u);
+    EXPECT_EQ(logger.written() + logger.dropped(), 10000u);
+    EXPECT_EQ(read_lines().size(), 1 + logger.written());
+}
+
+TEST_F(CDRLoggerTest, BlockingModeLosesNothing) {
+    pgw::CdrOptions options;
+    options.queue_size = 4;
+    options.block_when_full = true;
+    pgw::CDRLogger logger(cdr_file, options);
+    
+    for (int i = 0; i < 10000; ++i) {
+        logger.log(pgw::Imsi("111111"), pgw::CdrAction::CREATED);
+    }
+    logger.flush();
+    
+    EXPECT_EQ(logger.dropped(), 0u);
+    EXPECT_EQ(logger.written(), 10000u);
+}
+
+TEST(CdrRecordTest, BinaryRoundTrip) {
+    const pgw::CdrRecord record{1760000000123000000, pgw::Imsi("001010123456780").raw(),
+                                pgw::CdrAction::EXPIRED};
+    std::string bytes;
+    pgw::append_binary(bytes, record);
+    ASSERT_EQ(bytes.size(), pgw::kCdrBinaryRecordSize);
+    
+    auto decoded = pgw::decode_binary(bytes.data());
+    ASSERT_TRUE(decoded.has_value());
+    EXPECT_EQ(decoded->timestamp_ns, 1760000000123000000);  // точность - миллисекунды
+    EXPECT_EQ(decoded->imsi, record.imsi);
+    EXPECT_EQ(decoded->action, pgw::CdrAction::EXPIRED);
+    
+    bytes[14] = 42;  // неизвестное действие
+    EXPECT_FALSE(pgw::decode_binary(bytes.data()).has_value());
+}
+
+TEST_F(CDRLoggerTest, BinaryFormat) {
+    pgw::CdrOptions options;
+    options.format = pgw::CdrFormat::BINARY;
+    {
+        pgw::CDRLogger logger(cdr_file, options);
+        logger.log(pgw::Imsi("001010123456780"), pgw::CdrAction::CREATED);
+        logger.log(pgw::Imsi("001010123456789"), pgw::CdrAction::REJECTED);
+    }
+    
+    std::ifstream file(cdr_file, std::ios::binary);
+    std::string content((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    ASSERT_EQ(content.size(), pgw::kCdrBinaryMagic.size() + 2 * pgw::kCdrBinaryRecordSize);
+    EXPECT_EQ(content.substr(0, pgw::kCdrBinaryMagic.size()), pgw::kCdrBinaryMagic);
+    
+    auto second = pgw::decode_binary(content.data() + pgw::kCdrBinaryMagic.size() + pgw::kCdrBinaryRecordSize);
+    ASSERT_TRUE(second.has_value());
+    EXPECT_EQ(pgw::Imsi::from_raw(second->imsi).to_string(), "001010123456789");
+    EXPECT_EQ(second->action, pgw::CdrAction::REJECTED);
+}
+
+TEST_F(CDRLoggerTest, WriteErrorKeepsRecordsAligned) {
+    pgw::CdrOptions options;
+    options.format = pgw::CdrFormat::BINARY;
+    options.flush_interval_ms = 10;
+    
+    // лимит размера файла обрывает пачку на середине записи (EFBIG вместо сигнала)
+    auto previous_handler = std::signal(SIGXFSZ, SIG_IGN);
+    rlimit previous_limit{};
+    getrlimit(RLIMIT_FSIZE, &previous_limit);
+    rlimit limit = previous_limit;
+    limit.rlim_cur = pgw::kCdrBinaryMagic.size() + 10 * pgw::kCdrBinaryRecordSize + 5;
+    ASSERT_EQ(setrlimit(RLIMIT_FSIZE, &limit), 0);
+    
+    pgw::CDRLogger logger(cdr_file, options);
+    for (int i = 0; i < 100; ++i) {
+        logger.log(pgw::Imsi("001010123456780"), pgw::CdrAction::CREATED);
+    }
+    
+    // недописанный хвост обрезан, записи не засчитаны. файл проверяем между
+    // повторами: во время самой попытки хвост на мгновение появляется
+    bool truncated = false;
+    for (int i = 0; i < 100 && !truncated; ++i) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(3));
+        truncated = std::filesystem::file_size(cdr_file) == pgw::kCdrBinaryMagic.size();
+    }
+    EXPECT_TRUE(truncated);
+    EXPECT_EQ(logger.written(), 0u);
+    
+    // место появилось - та же пачка дописывается при повторе
+    setrlimit(RLIMIT_FSIZE, &previous_limit);
+    std::signal(SIGXFSZ, previous_handler);
+    logger.flush();
+    EXPECT_EQ(logger.written(), 100u);
+    EXPECT_EQ(logger.dropped(), 0u);
+    EXPECT_EQ(std::filesystem::file_size(cdr_file),
+              pgw::kCdrBinaryMagic.size() + 100 * pgw::kCdrBinaryRecordSize);
+}
+
+TEST_F(CDRLoggerTest, RotatesBySize) {
+    pgw::CdrOptions options;
+    options.rotate_bytes = 1024;
+    pgw::CDRLogger logger(cdr_file, options);
+    
+    // каждая пачка уходит отдельно, чтобы сработал порог размера
+    for (int batch = 0; batch < 5; ++batch) {
+        for (int i = 0; i < 20; ++i) {
+            logger.log(pgw::Imsi("001010123456780"), pgw::CdrAction::CREATED);
+        }
+        logger.flush();
+    }
+    EXPECT_GE(logger.rotations(), 2u);
+    
+    // архивы лежат рядом с исходным файлом, суммарно все записи на месте
+    size_t total_lines = 0;
+    const auto dir = std::filesystem::path(cdr_file).parent_path();
+    const auto name = std::filesystem::path(cdr_file).filename().string();
+    for (const auto& entry : std::filesystem::directory_iterator(dir)) {
+        const auto file_name = entry.path().filename().string();
+        if (file_name.rfind(name, 0) != 0) continue;
+        std::ifstream file(entry.path());
+        for (std::string line; std::getline(file, line); ) {
+            if (line != "timestamp,imsi,action") total_lines++;
+        }
+        if (file_name != name) std::filesystem::remove(entry.path());
+    }
+    EXPECT_EQ(total_lines, 100u);
+}
@@ -6,6 +6,22 @@
 
 namespace fs = std::filesystem;
 
+namespace {
+
+// минимальный корректный конфиг с дополнительными полями
+fs::path write_config(const std::string& extra) {
+    const auto path = fs::temp_directory_path() / "enum_config.json";
+    std::ofstream file(path.string());
+    file << R"({
+        "udp_ip": "0.0.0.0", "udp_port": 9000, "session_timeout_sec": 30,
+        "cdr_file": "cdr.log", "http_port": 8080, "graceful_shutdown_rate": 10,
+        "log_file": "pgw.log", "log_level": "INFO", "blacklist": [],
+        "max_sessions": 10000)" << extra << "}";
+    return path;
+}
+
+} // namespace
+
 TEST(ConfigTest, LoadValidConfig) {
     // создаем временный конфиг
     const auto temp_path = fs::temp_directory_path() / "test_config.json";
@@ -41,6 +57,19 @@ TEST(ConfigTest, LoadValidConfig) {
     EXPECT_EQ(config.blacklist[0], "001010123456789");
     EXPECT_EQ(config.max_sessions, 10000);
     
+    // необязательные параметры HTTP получают значения по умолчанию
+    EXPECT_EQ(config.http_threads, 4u);
+    EXPECT_EQ(config.http_keep_alive_max_count, 100u);
+    EXPECT_EQ(config.http_read_timeout_ms, 5000u);
+    EXPECT_TRUE(config.http_cpu_affinity.empty());
+    EXPECT_EQ(config.udp_backend, pgw::UdpBackend::EPOLL);
+    EXPECT_TRUE(config.state_dir.empty());
+    EXPECT_EQ(config.cdr_overflow, pgw::OverflowPolicy::BLOCK);
+    EXPECT_EQ(config.log_overflow, pgw::OverflowPolicy::BLOCK);
+    EXPECT_EQ(config.cdr_format, pgw::CdrFormat::CSV);
+    EXPECT_EQ(config.cdr_rotate_bytes, 0u);
+    EXPECT_EQ(config.cdr_rotate_interval_sec, 0u);
+    
     // удаляем временный файл
     fs::remove(temp_path);
 }
@@ -66,4 +95,25 @@ TEST(ConfigTest, InvalidJson) {
     }, nlohmann::json::exception); 
     
     fs::remove(temp_path);
-}
\ No newline at end of file
+}
+
+TEST(ConfigTest, EnumValues) {
+    const auto path = write_config(R"(, "udp_backend": "io_uring", "cdr_overflow": "drop",
+        "cdr_format": "binary", "log_overflow": "drop")");
+    const auto config = pgw::load_server_config(path.string());
+    EXPECT_EQ(config.udp_backend, pgw::UdpBackend::IO_URING);
+    EXPECT_EQ(config.cdr_overflow, pgw::OverflowPolicy::DROP);
+    EXPECT_EQ(config.cdr_format, pgw::CdrFormat::BINARY);
+    EXPECT_EQ(config.log_overflow, pgw::OverflowPolicy::DROP);
+    fs::remove(path);
+}
+
+TEST(ConfigTest, UnknownEnumValueRejected) {
+    // опечатка не должна молча включать значение по умолчанию
+    for (const char* extra : {R"(, "cdr_format": "bin")", R"(, "udp_backend": "iouring")",
+                              R"(, "cdr_overflow": "Drop")", R"(, "log_overflow": "discard")"}) {
+        const auto path = write_config(extra);
+        EXPECT_THROW(pgw::load_server_config(path.string()), std::runtime_error) << extra;
+        fs::remove(path);
+    }
+}
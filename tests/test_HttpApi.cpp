@@ -3,6 +3,7 @@
 #include "SessionManager.hpp"
 #include "CDRLogger.hpp"
 #include <httplib.h>
+#include <algorithm>
 #include <atomic>
 #include <thread>
 #include <future>
@@ -47,6 +48,15 @@ protected:
         return res ? res->body : "";
     }
     
+    std::string send_post_request(const std::string& path, const std::string& body,
+                                  const std::string& content_type, int* status = nullptr) {
+        httplib::Client client("localhost", 8080);
+        client.set_connection_timeout(2);
+        auto res = client.Post(path.c_str(), body, content_type.c_str());
+        if (status) *status = res ? res->status : 0;
+        return res ? res->body : "";
+    }
+    
     std::set<std::string> blacklist;
     std::unique_ptr<pgw::SessionManager> session_manager;
     std::unique_ptr<pgw::CDRLogger> cdr_logger;
@@ -74,6 +84,41 @@ TEST_F(HttpApiTest, CheckSubscriberMissingParam) {
     EXPECT_NE(response.find("IMSI parameter is required"), std::string::npos);
 }
 
+TEST_F(HttpApiTest, CheckSubscriberInvalidImsi) {
+    auto response = send_http_request("/check_subscriber?imsi=12345abc");
+    EXPECT_NE(response.find("invalid IMSI"), std::string::npos);
+}
+
+TEST_F(HttpApiTest, CheckSubscribersBulk) {
+    session_manager->try_create_session("123456789012345");
+    
+    // JSON и построчный формат дают одинаковый ответ
+    auto json = send_post_request("/check_subscribers",
+                                  R"({"imsis":["123456789012345","001010000000001","12ab"]})",
+                                  "application/json");
+    auto lines = send_post_request("/check_subscribers",
+                                   "123456789012345\r\n001010000000001\n\n12ab\n", "text/plain");
+    EXPECT_NE(json.find(R"({"imsi":"123456789012345","state":"active","idle_ms":)"), std::string::npos);
+    EXPECT_NE(json.find(R"({"imsi":"001010000000001","state":"not active"})"), std::string::npos);
+    EXPECT_NE(json.find(R"({"imsi":"12ab","state":"invalid"})"), std::string::npos);
+    EXPECT_EQ(json.substr(0, json.find("idle_ms")), lines.substr(0, lines.find("idle_ms")));
+    
+    int status = 0;
+    send_post_request("/check_subscribers", "[1, 2", "application/json", &status);
+    EXPECT_EQ(status, 400);
+}
+
+TEST_F(HttpApiTest, SessionsDump) {
+    session_manager->try_create_session("123456789012345");
+    session_manager->try_create_session("001010000000001");
+    
+    auto response = send_http_request("/sessions");
+    EXPECT_EQ(response.rfind("imsi,idle_ms,ttl_ms\n", 0), 0u);
+    EXPECT_NE(response.find("\n123456789012345,"), std::string::npos);
+    EXPECT_NE(response.find("\n001010000000001,"), std::string::npos);
+    EXPECT_EQ(std::count(response.begin(), response.end(), '\n'), 3);
+}
+
 TEST_F(HttpApiTest, StopEndpoint) {
     // создаем несколько сессий
     session_manager->try_create_session("111111111111111");
@@ -85,6 +130,39 @@ TEST_F(HttpApiTest, StopEndpoint) {
     // ждем завершения graceful shutdown
     std::this_thread::sleep_for(1500ms);
     
-    // проверяем что сессии удалены
+    // проверяем что сессии удалены, а сервер попросили остановиться
     EXPECT_EQ(session_manager->active_sessions(), 0);
-}
\ No newline at end of file
+    EXPECT_TRUE(shutdown_requested);
+    EXPECT_NE(send_http_request("/stop/status").find("\"state\":\"completed\""), std::string::npos);
+}
+
+TEST_F(HttpApiTest, StopCancel) {
+    for (int i = 0; i < 50; ++i) {
+        session_manager->try_create_session(pgw::Imsi("00101" + std::to_string(1000000000 + i)));
+    }
+    
+    // 5 сессий в секунду: за полсекунды удаление не закончится
+    EXPECT_EQ(send_http_request("/stop"), "Initiating graceful shutdown...");
+    EXPECT_EQ(send_http_request("/stop"), "Graceful shutdown already in progress");
+    std::this_thread::sleep_for(500ms);
+    EXPECT_NE(send_http_request("/stop/status").find("\"state\":\"running\""), std::string::npos);
+    
+    EXPECT_EQ(send_http_request("/stop/cancel"), "Graceful shutdown cancelled");
+    EXPECT_FALSE(shutdown_requested);
+    EXPECT_GT(session_manager->active_sessions(), 0u);
+    EXPECT_TRUE(session_manager->accepting());
+}
+TEST_F(HttpApiTest, ReloadNotConfigured) {
+    // обработчик перезагрузки задает main, в тесте его нет
+    EXPECT_EQ(send_http_request("/reload"), "Reload is not configured");
+}
+
+TEST_F(HttpApiTest, Metrics) {
+    session_manager->try_create_session("123456789012345");
+    
+    auto response = send_http_request("/metrics");
+    EXPECT_NE(response.find("pgw_active_sessions 1\n"), std::string::npos);
+    EXPECT_NE(response.find("pgw_cdr_queue_depth "), std::string::npos);
+    EXPECT_NE(response.find("pgw_udp_packets_received_total "), std::string::npos);
+    EXPECT_NE(response.find("pgw_request_duration_seconds_count "), std::string::npos);
+}
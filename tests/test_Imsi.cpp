@@ -0,0 +1,35 @@
+#include "gtest/gtest.h"
+#include "Imsi.hpp"
+#include <unordered_set>
+
+TEST(ImsiTest, ParseAndFormat) {
+    auto imsi = pgw::Imsi::parse("001010123456780");
+    ASSERT_TRUE(imsi.has_value());
+    EXPECT_EQ(imsi->length(), 15u);
+    EXPECT_EQ(imsi->to_string(), "001010123456780");
+    
+    // ведущие нули сохраняются, короткие IMSI допустимы
+    EXPECT_EQ(pgw::Imsi("0").to_string(), "0");
+    EXPECT_NE(pgw::Imsi("01"), pgw::Imsi("001"));
+    EXPECT_EQ(fmt::format("{}", pgw::Imsi("123456")), "123456");
+}
+
+TEST(ImsiTest, RejectsInvalid) {
+    EXPECT_FALSE(pgw::Imsi::parse(""));
+    EXPECT_FALSE(pgw::Imsi::parse("0010101234567801"));  // 16 цифр
+    EXPECT_FALSE(pgw::Imsi::parse("00101012345678a"));
+    EXPECT_FALSE(pgw::Imsi::parse(std::string_view("123\0", 4)));
+    EXPECT_THROW(pgw::Imsi("abc"), std::invalid_argument);
+    EXPECT_FALSE(pgw::Imsi().valid());
+}
+
+TEST(ImsiTest, OrderMatchesStrings) {
+    // порядок упакованных значений совпадает с лексикографическим
+    EXPECT_LT(pgw::Imsi("12"), pgw::Imsi("120"));
+    EXPECT_LT(pgw::Imsi("120"), pgw::Imsi("13"));
+    EXPECT_LT(pgw::Imsi("001010000000001"), pgw::Imsi("001010123456789"));
+    
+    std::unordered_set<pgw::Imsi> set = {pgw::Imsi("111111"), pgw::Imsi("222222")};
+    EXPECT_EQ(set.count(pgw::Imsi("111111")), 1u);
+    EXPECT_EQ(set.count(pgw::Imsi("333333")), 0u);
+}
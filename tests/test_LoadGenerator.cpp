@@ -0,0 +1,104 @@
+#include "gtest/gtest.h"
+#include "LoadGenerator.hpp"
+#include "UdpStub.hpp"
+#include <string>
+#include <vector>
+
+namespace {
+
+pgw::ClientConfig make_config(uint16_t port) {
+    pgw::ClientConfig config;
+    config.server_ip = "127.0.0.1";
+    config.server_port = port;
+    config.request_timeout_ms = 100;
+    config.max_retries = 0;
+    config.pipeline_sockets = 1;
+    config.protocol = "text";
+    config.imsis_per_packet = 1;
+    return config;
+}
+
+pgw::LoadOptions make_options() {
+    pgw::LoadOptions options;
+    options.threads = 2;
+    options.sockets = 2;
+    options.window = 8;
+    options.batch = 4;
+    options.duration_sec = 0;
+    options.total_requests = 400;
+    options.timeout_ms = 100;
+    options.imsi_count = 1000;
+    return options;
+}
+
+} // namespace
+
+TEST(LoadGeneratorTest, CountsEveryAnswer) {
+    const pgw::LoadOptions options = [] {
+        auto options = make_options();
+        options.blacklist_ratio = 0.25;
+        return options;
+    }();
+    UdpStub stub([&](std::string_view request, unsigned) {
+        return std::vector<std::string>{request == options.blacklist_imsi ? "rejected" : "created"};
+    });
+    const auto config = make_config(stub.port());
+
+    const auto report = pgw::LoadGenerator(config, options).run();
+    EXPECT_EQ(report.sent, 400u);
+    EXPECT_EQ(stub.received(), 400u);
+    EXPECT_EQ(report.received, 400u);
+    EXPECT_EQ(report.lost, 0u);
+    EXPECT_EQ(report.send_errors, 0u);
+    EXPECT_GT(report.rejected, 0u);
+    EXPECT_EQ(report.created + report.rejected, report.received);
+    EXPECT_EQ(report.latency.count(), report.received);
+}
+
+TEST(LoadGeneratorTest, LostAnswersCountedOnce) {
+    // каждый десятый запрос остается без ответа
+    uint64_t seen = 0;  // только поток заглушки
+    UdpStub stub([&](std::string_view, unsigned) {
+        if (++seen % 10 == 0) return std::vector<std::string>{};
+        return std::vector<std::string>{"created"};
+    });
+    const auto config = make_config(stub.port());
+    const auto options = make_options();
+
+    const auto report = pgw::LoadGenerator(config, options).run();
+    EXPECT_EQ(report.sent, 400u);
+    EXPECT_GT(report.lost, 0u);
+    // каждый отправленный запрос либо получил ответ, либо учтен как потерянный
+    EXPECT_EQ(report.received + report.lost, report.sent);
+    EXPECT_LE(report.received, 360u);
+}
+
+TEST(LoadGeneratorTest, DuplicateAnswersIgnored) {
+    // лишний ответ не должен засчитываться за еще не отправленный запрос
+    UdpStub stub([](std::string_view, unsigned) {
+        return std::vector<std::string>{"created", "created"};
+    });
+    const auto config = make_config(stub.port());
+    auto options = make_options();
+    options.threads = 1;
+    options.sockets = 1;
+    options.window = 1;
+    options.batch = 1;
+    options.total_requests = 50;
+
+    const auto report = pgw::LoadGenerator(config, options).run();
+    EXPECT_EQ(report.sent, 50u);
+    EXPECT_LE(report.received, report.sent);
+    EXPECT_EQ(report.received + report.lost, report.sent);
+}
+
+TEST(LatencyHistogramTest, Percentiles) {
+    pgw::LatencyHistogram histogram;
+    for (int us = 1; us <= 100; ++us) {
+        histogram.record(std::chrono::microseconds(us));
+    }
+    EXPECT_EQ(histogram.count(), 100u);
+    EXPECT_EQ(histogram.percentile_us(0.5), 50u);
+    EXPECT_EQ(histogram.percentile_us(0.99), 99u);
+    EXPECT_EQ(histogram.max_us(), 100u);
+}
@@ -0,0 +1,64 @@
+#include <gtest/gtest.h>
+#include <spdlog/sinks/ostream_sink.h>
+#include <chrono>
+#include <memory>
+#include <sstream>
+#include <thread>
+#include "LogSampler.hpp"
+
+namespace {
+
+// перехватываем вывод логгера по умолчанию на время теста
+class LogSamplerTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        previous_ = spdlog::default_logger();
+        auto logger = std::make_shared<spdlog::logger>("sampler_test",
+            std::make_shared<spdlog::sinks::ostream_sink_st>(output_));
+        logger->set_level(spdlog::level::info);
+        spdlog::set_default_logger(logger);
+    }
+    
+    void TearDown() override {
+        spdlog::set_default_logger(previous_);
+        pgw::LogSampler::set_rate(100);
+    }
+    
+    std::ostringstream output_;
+    std::shared_ptr<spdlog::logger> previous_;
+};
+
+} // namespace
+
+TEST_F(LogSamplerTest, LimitsPerSecondAndReportsSummary) {
+    pgw::LogSampler::set_rate(3);
+    pgw::LogSampler sampler("Тестовые сообщения");
+    
+    unsigned allowed = 0;
+    for (int i = 0; i < 10; ++i) {
+        if (sampler.allow()) allowed++;
+    }
+    EXPECT_EQ(allowed, 3u);
+    EXPECT_EQ(sampler.suppressed_total(), 7u);
+    EXPECT_EQ(output_.str().find("пропущено"), std::string::npos);
+    
+    // после окончания окна сводка выводится без новых сообщений
+    std::this_thread::sleep_for(std::chrono::milliseconds(1100));
+    pgw::LogSampler::report_all();
+    EXPECT_NE(output_.str().find("Тестовые сообщения: еще 7 сообщений"), std::string::npos);
+    
+    // новое окно - новый лимит
+    EXPECT_TRUE(sampler.allow());
+}
+
+TEST_F(LogSamplerTest, DisabledLevelAndUnlimited) {
+    pgw::LogSampler debug_sampler("debug", spdlog::level::debug);
+    EXPECT_FALSE(debug_sampler.allow());
+    
+    pgw::LogSampler::set_rate(0);
+    pgw::LogSampler sampler("unlimited");
+    for (int i = 0; i < 1000; ++i) {
+        ASSERT_TRUE(sampler.allow());
+    }
+    EXPECT_EQ(sampler.suppressed_total(), 0u);
+}
@@ -0,0 +1,41 @@
+#include <gtest/gtest.h>
+#include <string>
+#include <thread>
+#include <vector>
+#include "Metrics.hpp"
+
+// метрики глобальные, поэтому проверяем приращения, а не абсолютные значения
+
+TEST(MetricsTest, ConcurrentIncrementsAreNotLost) {
+    const uint64_t before = pgw::Metrics::value(pgw::Metric::UDP_RECEIVED);
+    
+    constexpr int kThreads = 8;
+    constexpr int kPerThread = 100000;
+    std::vector<std::thread> threads;
+    for (int t = 0; t < kThreads; ++t) {
+        threads.emplace_back([] {
+            for (int i = 0; i < kPerThread; ++i) {
+                pgw::Metrics::increment(pgw::Metric::UDP_RECEIVED);
+            }
+        });
+    }
+    for (auto& thread : threads) thread.join();
+    
+    EXPECT_EQ(pgw::Metrics::value(pgw::Metric::UDP_RECEIVED) - before, uint64_t(kThreads) * kPerThread);
+}
+
+TEST(MetricsTest, RenderPrometheusText) {
+    pgw::Metrics::increment(pgw::Metric::REJECTED_BLACKLIST, 3);
+    pgw::Metrics::observe_latency(std::chrono::microseconds(3));     // корзина le=5e-06
+    pgw::Metrics::observe_latency(std::chrono::milliseconds(100));  // только +Inf
+    
+    const std::string text = pgw::Metrics::render();
+    EXPECT_NE(text.find("# TYPE pgw_session_requests_total counter\n"), std::string::npos);
+    EXPECT_NE(text.find("pgw_session_requests_total{result=\"rejected_blacklist\"} "), std::string::npos);
+    EXPECT_NE(text.find("# TYPE pgw_request_duration_seconds histogram\n"), std::string::npos);
+    EXPECT_NE(text.find("pgw_request_duration_seconds_bucket{le=\"5e-06\"} "), std::string::npos);
+    EXPECT_NE(text.find("pgw_request_duration_seconds_bucket{le=\"+Inf\"} "), std::string::npos);
+    // HELP/TYPE для метрики с метками выводится один раз
+    const auto first = text.find("# TYPE pgw_session_requests_total");
+    EXPECT_EQ(text.find("# TYPE pgw_session_requests_total", first + 1), std::string::npos);
+}
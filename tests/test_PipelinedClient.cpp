@@ -0,0 +1,197 @@
+#include "gtest/gtest.h"
+#include "PipelinedClient.hpp"
+#include "UdpStub.hpp"
+#include <string>
+#include <vector>
+
+using Status = pgw::RequestResult::Status;
+
+namespace {
+
+// IMSI запроса: текстовый - вся датаграмма, бинарный - все IMSI пакета
+std::vector<std::string> request_imsis(std::string_view request) {
+    auto header = pgw::decode_header(request);
+    if (!header) return {std::string(request)};
+    std::vector<std::string> imsis;
+    for (size_t i = 0; i < header->count; ++i) {
+        const auto* tbcd = reinterpret_cast<const uint8_t*>(
+            request.data() + pgw::kPacketHeaderSize + i * pgw::Imsi::kTbcdSize);
+        imsis.push_back(pgw::Imsi::from_tbcd(tbcd, pgw::Imsi::kTbcdSize)->to_string());
+    }
+    return imsis;
+}
+
+bool contains(std::string_view request, const std::string& imsi) {
+    for (const auto& item : request_imsis(request)) {
+        if (item == imsi) return true;
+    }
+    return false;
+}
+
+// ответ как у сервера: rejected и некорректные IMSI отклоняются, остальные создаются
+std::string answer(std::string_view request, const std::string& rejected) {
+    auto header = pgw::decode_header(request);
+    if (!header) {
+        const bool reject = request == rejected || !pgw::Imsi::parse(request);
+        return reject ? "rejected" : "created";
+    }
+    std::string packet(pgw::kPacketHeaderSize, '\0');
+    pgw::encode_header(packet.data(), {pgw::response_type(header->type), header->count, header->seq});
+    for (const auto& imsi : request_imsis(request)) {
+        packet += static_cast<char>(imsi == rejected ? pgw::ResultCode::REJECTED_BLACKLIST
+                                                     : pgw::ResultCode::CREATED);
+    }
+    return packet;
+}
+
+std::vector<std::string> make_imsis(size_t count) {
+    std::vector<std::string> imsis;
+    for (size_t i = 0; i < count; ++i) {
+        std::string suffix = std::to_string(i);
+        imsis.push_back("00101" + std::string(10 - suffix.size(), '0') + suffix);
+    }
+    return imsis;
+}
+
+} // namespace
+
+// сценарии для текстового и бинарного протоколов
+class PipelinedClientTest : public ::testing::TestWithParam<std::string> {
+protected:
+    pgw::ClientConfig make_config(uint16_t port, unsigned sockets, unsigned imsis_per_packet) const {
+        pgw::ClientConfig config;
+        config.server_ip = "127.0.0.1";
+        config.server_port = port;
+        config.request_timeout_ms = 30;
+        config.max_retries = 2;
+        config.pipeline_sockets = sockets;
+        config.protocol = GetParam();
+        config.imsis_per_packet = imsis_per_packet;
+        return config;
+    }
+
+    bool binary() const { return GetParam() == "binary"; }
+    std::string rejected_response() const { return binary() ? "rejected_blacklist" : "rejected"; }
+
+    const std::string blocked = "001010123456789";
+};
+
+INSTANTIATE_TEST_SUITE_P(
+    Protocols, PipelinedClientTest, ::testing::Values("text", "binary"),
+    [](const ::testing::TestParamInfo<std::string>& info) { return info.param; });
+
+TEST_P(PipelinedClientTest, ResultsInInputOrder) {
+    UdpStub stub([this](std::string_view request, unsigned) {
+        return std::vector<std::string>{answer(request, blocked)};
+    });
+    const auto config = make_config(stub.port(), 4, 3);
+    pgw::PipelinedClient client(config);
+
+    auto imsis = make_imsis(20);
+    imsis[7] = blocked;
+    imsis[12] = "12ab";
+    const auto results = client.send_batch(imsis);
+
+    ASSERT_EQ(results.size(), imsis.size());
+    for (size_t i = 0; i < imsis.size(); ++i) {
+        EXPECT_EQ(results[i].imsi, imsis[i]) << i;
+        if (i == 12 && binary()) {
+            // некорректный IMSI не упаковать - запрос не отправлялся
+            EXPECT_EQ(results[i].status, Status::INVALID_IMSI);
+            EXPECT_EQ(results[i].attempts, 0u);
+            continue;
+        }
+        EXPECT_EQ(results[i].status, Status::OK) << i;
+        EXPECT_EQ(results[i].attempts, 1u) << i;
+        EXPECT_EQ(results[i].response, i == 7 || i == 12 ? rejected_response() : "created") << i;
+    }
+    EXPECT_EQ(client.pending(), 0u);
+}
+
+TEST_P(PipelinedClientTest, RetransmitsLostRequests) {
+    // первая попытка каждого пакета теряется
+    UdpStub stub([this](std::string_view request, unsigned attempt) {
+        if (attempt == 1) return std::vector<std::string>{};
+        return std::vector<std::string>{answer(request, blocked)};
+    });
+    const auto config = make_config(stub.port(), 4, 2);
+    pgw::PipelinedClient client(config);
+
+    const auto imsis = make_imsis(8);
+    const auto results = client.send_batch(imsis);
+    for (size_t i = 0; i < imsis.size(); ++i) {
+        EXPECT_EQ(results[i].imsi, imsis[i]);
+        EXPECT_EQ(results[i].status, Status::OK);
+        EXPECT_EQ(results[i].attempts, 2u);
+        EXPECT_EQ(results[i].response, "created");
+    }
+}
+
+TEST_P(PipelinedClientTest, TimesOutAfterRetries) {
+    const auto imsis = make_imsis(6);
+    const std::string lost = imsis[2];
+    UdpStub stub([&](std::string_view request, unsigned) {
+        if (contains(request, lost)) return std::vector<std::string>{};
+        return std::vector<std::string>{answer(request, blocked)};
+    });
+    const auto config = make_config(stub.port(), 2, 1);
+    pgw::PipelinedClient client(config);
+
+    const auto results = client.send_batch(imsis);
+    for (size_t i = 0; i < imsis.size(); ++i) {
+        EXPECT_EQ(results[i].imsi, imsis[i]);
+        if (i == 2) {
+            EXPECT_EQ(results[i].status, Status::TIMEOUT);
+            EXPECT_EQ(results[i].attempts, config.max_retries + 1);
+            EXPECT_TRUE(results[i].response.empty());
+        } else {
+            EXPECT_EQ(results[i].status, Status::OK);
+            EXPECT_EQ(results[i].attempts, 1u);
+        }
+    }
+}
+
+TEST_P(PipelinedClientTest, StaleDuplicateDoesNotReachNextRequest) {
+    // на повтор первого запроса приходят два ответа: верный и устаревший
+    // "rejected". сокет один, следующий запрос идет по нему же: текстовый
+    // клиент меняет сокет после повтора, бинарный отбрасывает ответ по seq
+    const auto imsis = make_imsis(3);
+    UdpStub stub([&](std::string_view request, unsigned attempt) {
+        if (!contains(request, imsis[0])) return std::vector<std::string>{answer(request, blocked)};
+        if (attempt == 1) return std::vector<std::string>{};
+        return std::vector<std::string>{answer(request, blocked), answer(request, imsis[0])};
+    });
+    const auto config = make_config(stub.port(), 1, 1);
+    pgw::PipelinedClient client(config);
+
+    const auto results = client.send_batch(imsis);
+    EXPECT_EQ(results[0].status, Status::OK);
+    EXPECT_EQ(results[0].attempts, 2u);
+    EXPECT_EQ(results[0].response, "created");
+    for (size_t i = 1; i < imsis.size(); ++i) {
+        EXPECT_EQ(results[i].status, Status::OK) << i;
+        EXPECT_EQ(results[i].attempts, 1u) << i;
+        EXPECT_EQ(results[i].response, "created") << i;
+    }
+}
+
+TEST_P(PipelinedClientTest, CallbacksFromPoll) {
+    UdpStub stub([this](std::string_view request, unsigned) {
+        return std::vector<std::string>{answer(request, blocked)};
+    });
+    const auto config = make_config(stub.port(), 2, 4);
+    pgw::PipelinedClient client(config, pgw::PacketType::CREATE_REQUEST);
+
+    std::vector<std::string> completed;
+    for (const auto& imsi : make_imsis(5)) {
+        client.submit(imsi, [&](const pgw::RequestResult& result) {
+            EXPECT_EQ(result.status, Status::OK);
+            completed.push_back(result.imsi);
+        });
+    }
+    EXPECT_EQ(client.pending(), 5u);
+    size_t done = 0;
+    while (client.pending() > 0) done += client.poll(100);
+    EXPECT_EQ(done, 5u);
+    EXPECT_EQ(completed.size(), 5u);
+}
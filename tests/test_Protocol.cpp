@@ -0,0 +1,80 @@
+#include "gtest/gtest.h"
+#include "Protocol.hpp"
+
+TEST(ProtocolTest, TbcdRoundTrip) {
+    uint8_t tbcd[pgw::Imsi::kTbcdSize];
+    pgw::Imsi("001010123456780").to_tbcd(tbcd);
+    // первая цифра в младшем полубайте, 15-я цифра дополнена 0xF
+    EXPECT_EQ(tbcd[0], 0x00);
+    EXPECT_EQ(tbcd[1], 0x01);
+    EXPECT_EQ(tbcd[2], 0x01);
+    EXPECT_EQ(tbcd[7], 0xF0);
+    EXPECT_EQ(pgw::Imsi::from_tbcd(tbcd, sizeof(tbcd)), pgw::Imsi("001010123456780"));
+    
+    pgw::Imsi("12345").to_tbcd(tbcd);
+    EXPECT_EQ(tbcd[2], 0xF5);
+    EXPECT_EQ(tbcd[3], 0xFF);
+    EXPECT_EQ(pgw::Imsi::from_tbcd(tbcd, sizeof(tbcd)), pgw::Imsi("12345"));
+    
+    // цифра после заполнителя, недопустимый полубайт, пустой IMSI
+    const uint8_t gap[] = {0x21, 0x3F, 0x54};
+    const uint8_t bad[] = {0x21, 0xA3};
+    const uint8_t empty[] = {0xFF, 0xFF};
+    EXPECT_FALSE(pgw::Imsi::from_tbcd(gap, sizeof(gap)));
+    EXPECT_FALSE(pgw::Imsi::from_tbcd(bad, sizeof(bad)));
+    EXPECT_FALSE(pgw::Imsi::from_tbcd(empty, sizeof(empty)));
+}
+
+TEST(ProtocolTest, RequestEncoding) {
+    const std::vector<pgw::Imsi> imsis = {pgw::Imsi("001010123456780"), pgw::Imsi("250991234567")};
+    const std::string packet = pgw::encode_request(0xDEADBEEF, imsis);
+    ASSERT_EQ(packet.size(), pgw::kPacketHeaderSize + 2 * pgw::Imsi::kTbcdSize);
+    EXPECT_TRUE(pgw::is_binary_packet(packet));
+    EXPECT_FALSE(pgw::is_binary_packet("001010123456780"));
+    
+    auto header = pgw::decode_header(packet);
+    ASSERT_TRUE(header.has_value());
+    EXPECT_EQ(header->type, pgw::PacketType::CREATE_REQUEST);
+    EXPECT_EQ(header->count, 2);
+    EXPECT_EQ(header->seq, 0xDEADBEEFu);
+    
+    const auto* items = reinterpret_cast<const uint8_t*>(packet.data() + pgw::kPacketHeaderSize);
+    EXPECT_EQ(pgw::Imsi::from_tbcd(items + pgw::Imsi::kTbcdSize, pgw::Imsi::kTbcdSize),
+              pgw::Imsi("250991234567"));
+}
+
+TEST(ProtocolTest, DeleteAndRefreshRequests) {
+    const std::string packet = pgw::encode_request(9, {pgw::Imsi("001010123456780")},
+                                                   pgw::PacketType::DELETE_REQUEST);
+    auto header = pgw::decode_header(packet);
+    ASSERT_TRUE(header.has_value());
+    EXPECT_EQ(header->type, pgw::PacketType::DELETE_REQUEST);
+    EXPECT_TRUE(pgw::is_request(header->type));
+    EXPECT_EQ(pgw::response_type(header->type), pgw::PacketType::DELETE_RESPONSE);
+    EXPECT_EQ(pgw::response_type(pgw::PacketType::REFRESH_REQUEST), pgw::PacketType::REFRESH_RESPONSE);
+    EXPECT_FALSE(pgw::is_request(pgw::PacketType::REFRESH_RESPONSE));
+    
+    EXPECT_EQ(pgw::text_command(pgw::PacketType::CREATE_REQUEST), "");
+    EXPECT_EQ(pgw::text_command(pgw::PacketType::REFRESH_REQUEST), "refresh ");
+    EXPECT_EQ(pgw::to_string(pgw::ResultCode::NOT_FOUND), "not_found");
+}
+
+TEST(ProtocolTest, RejectsMalformedHeaders) {
+    const std::string packet = pgw::encode_request(1, {pgw::Imsi("001010123456780")});
+    
+    EXPECT_FALSE(pgw::decode_header(packet.substr(0, 7)));        // короткий заголовок
+    EXPECT_FALSE(pgw::decode_header(packet.substr(0, 12)));       // обрезанный IMSI
+    EXPECT_FALSE(pgw::decode_header(packet + '\0'));              // лишний байт
+    
+    std::string wrong_version = packet;
+    wrong_version[1] = 2;
+    EXPECT_FALSE(pgw::decode_header(wrong_version));
+    
+    std::string wrong_type = packet;
+    wrong_type[2] = 9;
+    EXPECT_FALSE(pgw::decode_header(wrong_type));
+    
+    std::string zero_count = packet.substr(0, pgw::kPacketHeaderSize);
+    zero_count[3] = 0;
+    EXPECT_FALSE(pgw::decode_header(zero_count));
+}
@@ -0,0 +1,131 @@
+#include <gtest/gtest.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <thread>
+#include "Reactor.hpp"
+
+using namespace std::chrono_literals;
+
+TEST(ReactorTest, TimerFiresAndRearms) {
+    pgw::Reactor reactor;
+    int fired = 0;
+    pgw::Reactor::TimerId timer = reactor.add_timer([&] {
+        // однократный таймер перезапускается из своего обработчика
+        if (++fired < 3) {
+            reactor.arm_timer(timer, 1ms);
+        } else {
+            reactor.stop();
+        }
+    });
+    reactor.arm_timer(timer, 1ms);
+
+    const auto start = std::chrono::steady_clock::now();
+    reactor.run();
+    EXPECT_EQ(fired, 3);
+    EXPECT_LT(std::chrono::steady_clock::now() - start, 1s);
+}
+
+TEST(ReactorTest, DisarmedTimerDoesNotFire) {
+    pgw::Reactor reactor;
+    bool fired = false;
+    auto timer = reactor.add_timer([&] { fired = true; });
+    reactor.arm_timer(timer, 1ms);
+    reactor.arm_timer(timer, 0ms);
+
+    auto stop_timer = reactor.add_timer([&] { reactor.stop(); });
+    reactor.arm_timer(stop_timer, 20ms);
+    reactor.run();
+    EXPECT_FALSE(fired);
+}
+
+TEST(ReactorTest, StopFromOtherThreadWakesImmediately) {
+    pgw::Reactor reactor;
+    std::thread loop([&] { reactor.run(); });
+    std::this_thread::sleep_for(20ms);
+
+    // без событий поток спит в epoll_wait, stop() будит его сразу
+    const auto start = std::chrono::steady_clock::now();
+    reactor.stop();
+    loop.join();
+    EXPECT_LT(std::chrono::steady_clock::now() - start, 100ms);
+    EXPECT_TRUE(reactor.stopping());
+}
+
+TEST(ReactorTest, StopBeforeRun) {
+    pgw::Reactor reactor;
+    reactor.stop();
+    reactor.run();  // не блокируется
+    SUCCEED();
+}
+
+TEST(ReactorTest, DescriptorHandler) {
+    const int fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    ASSERT_GE(fd, 0);
+
+    pgw::Reactor reactor;
+    uint64_t received = 0;
+    reactor.add(fd, EPOLLIN, [&](uint32_t events) {
+        EXPECT_TRUE(events & EPOLLIN);
+        uint64_t value;
+        while (read(fd, &value, sizeof(value)) == sizeof(value)) received += value;
+        if (received >= 5) reactor.stop();
+    });
+
+    std::thread writer([fd] {
+        for (int i = 0; i < 5; ++i) {
+            const uint64_t one = 1;
+            ASSERT_EQ(write(fd, &one, sizeof(one)), static_cast<ssize_t>(sizeof(one)));
+            std::this_thread::sleep_for(1ms);
+        }
+    });
+    reactor.run();
+    writer.join();
+    EXPECT_EQ(received, 5u);
+    close(fd);
+}
+
+TEST(ReactorTest, RemovedDescriptorIsIgnored) {
+    const int fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    ASSERT_GE(fd, 0);
+
+    pgw::Reactor reactor;
+    bool called = false;
+    reactor.add(fd, EPOLLIN, [&](uint32_t) { called = true; });
+    reactor.remove(fd);
+
+    const uint64_t one = 1;
+    ASSERT_EQ(write(fd, &one, sizeof(one)), static_cast<ssize_t>(sizeof(one)));
+    auto stop_timer = reactor.add_timer([&] { reactor.stop(); });
+    reactor.arm_timer(stop_timer, 20ms);
+    reactor.run();
+    EXPECT_FALSE(called);
+    close(fd);  // дескриптор остается за владельцем
+}
+
+TEST(ReactorTest, SignalDelivery) {
+    // сигнал должен быть заблокирован, иначе его доставит обработчик по умолчанию
+    sigset_t previous;
+    sigset_t set;
+    sigemptyset(&set);
+    sigaddset(&set, SIGUSR1);
+    pthread_sigmask(SIG_BLOCK, &set, &previous);
+
+    {
+        pgw::Reactor reactor;
+        int received = 0;
+        reactor.add_signals({SIGUSR1}, [&](int signal) {
+            received = signal;
+            reactor.stop();
+        });
+        pthread_kill(pthread_self(), SIGUSR1);
+        reactor.run();
+        EXPECT_EQ(received, SIGUSR1);
+    }
+
+    pthread_sigmask(SIG_SETMASK, &previous, nullptr);
+}
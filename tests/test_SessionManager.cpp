@@ -3,6 +3,11 @@
 #include <set>
 #include <thread>
 #include <chrono>
+#include <atomic>
+#include <memory>
+#include <vector>
+#include <fstream>
+#include <unistd.h>
 
 using namespace std::chrono_literals;
 
@@ -55,6 +60,30 @@ TEST(SessionManagerTest, SessionExpiration) {
     EXPECT_EQ(manager.active_sessions(), 0);
 }
 
+TEST(SessionManagerTest, RefreshExtendsIdleTimeout) {
+    std::set<std::string> blacklist;
+    pgw::SessionManager manager(1, blacklist, 100); // таймаут простоя 1 секунда
+    
+    manager.try_create_session("111111");
+    manager.try_create_session("222222");
+    EXPECT_FALSE(manager.refresh_session("333333"));
+    
+    // продлеваем одну сессию явно, другую повторным запросом на создание
+    std::this_thread::sleep_for(700ms);
+    EXPECT_TRUE(manager.refresh_session("111111"));
+    EXPECT_EQ(manager.try_create_session("222222"), pgw::SessionManager::CreateResult::ALREADY_EXISTS);
+    
+    // с создания прошло больше таймаута, с последней активности - меньше
+    std::this_thread::sleep_for(700ms);
+    manager.remove_expired_sessions();
+    EXPECT_TRUE(manager.is_active("111111"));
+    EXPECT_TRUE(manager.is_active("222222"));
+    
+    std::this_thread::sleep_for(500ms);
+    manager.remove_expired_sessions();
+    EXPECT_EQ(manager.active_sessions(), 0);
+}
+
 TEST(SessionManagerTest, RemoveSession) {
     std::set<std::string> blacklist;
     pgw::SessionManager manager(30, blacklist, 100);
@@ -62,10 +91,207 @@ TEST(SessionManagerTest, RemoveSession) {
     manager.try_create_session("111111");
     EXPECT_TRUE(manager.is_active("111111"));
     
-    manager.remove_session("111111");
+    EXPECT_TRUE(manager.remove_session("111111"));
     EXPECT_FALSE(manager.is_active("111111"));
+    EXPECT_EQ(manager.active_sessions(), 0);
     
     // удаление несуществующей сессии
-    manager.remove_session("999999");
+    EXPECT_FALSE(manager.remove_session("999999"));
     EXPECT_FALSE(manager.is_active("999999"));
-}
\ No newline at end of file
+}
+
+TEST(SessionManagerTest, ConcurrentCreateRespectsLimit) {
+    std::set<std::string> blacklist;
+    pgw::SessionManager manager(30, blacklist, 1000, 8);
+    
+    // несколько потоков создают сессии в разных сегментах одновременно
+    std::atomic<unsigned> created{0};
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t) {
+        threads.emplace_back([&manager, &created, t] {
+            for (int i = 0; i < 500; ++i) {
+                auto imsi = std::to_string(100000 + t * 1000 + i);
+                if (manager.try_create_session(imsi) == pgw::SessionManager::CreateResult::CREATED) {
+                    created++;
+                }
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    
+    // глобальный лимит соблюдается при конкурентной вставке
+    EXPECT_EQ(created.load(), 1000u);
+    EXPECT_EQ(manager.active_sessions(), 1000u);
+}
+
+TEST(SessionManagerTest, ExpiryOrderAndCdr) {
+    char tmp_file[] = "/tmp/pgw_test_XXXXXX";
+    int fd = mkstemp(tmp_file);
+    ASSERT_NE(fd, -1);
+    close(fd);
+    
+    std::set<std::string> blacklist;
+    pgw::SessionManager manager(1, blacklist, 100);
+    pgw::CDRLogger cdr_logger(tmp_file);
+    
+    manager.try_create_session("111111");
+    std::this_thread::sleep_for(600ms);
+    manager.try_create_session("222222");
+    std::this_thread::sleep_for(500ms);
+    
+    // истекает только более старая сессия
+    manager.remove_expired_sessions(cdr_logger);
+    EXPECT_FALSE(manager.is_active("111111"));
+    EXPECT_TRUE(manager.is_active("222222"));
+    EXPECT_EQ(manager.active_sessions(), 1u);
+    
+    // удаленная вручную сессия не ломает очередь истечения
+    manager.try_create_session("333333");
+    manager.remove_session("222222");
+    std::this_thread::sleep_for(1100ms);
+    manager.remove_expired_sessions(cdr_logger);
+    EXPECT_EQ(manager.active_sessions(), 0u);
+    
+    cdr_logger.flush();  // CDR пишется асинхронно
+    std::ifstream cdr(tmp_file);
+    std::string content((std::istreambuf_iterator<char>(cdr)), std::istreambuf_iterator<char>());
+    EXPECT_NE(content.find("111111,expired"), std::string::npos);
+    EXPECT_NE(content.find("333333,expired"), std::string::npos);
+    EXPECT_EQ(content.find("222222,expired"), std::string::npos);
+    std::remove(tmp_file);
+}
+
+TEST(SessionManagerTest, LastSeenBatch) {
+    std::set<std::string> blacklist;
+    pgw::SessionManager manager(30, blacklist, 1000);
+    
+    std::vector<pgw::Imsi> imsis;
+    for (int i = 0; i < 200; ++i) {
+        imsis.emplace_back("00101" + std::to_string(1000000000 + i));
+        if (i % 2 == 0) manager.try_create_session(imsis.back());
+    }
+    
+    // результаты в порядке запроса, независимо от сегментов
+    const auto before = std::chrono::steady_clock::now();
+    const auto seen = manager.last_seen_batch(imsis);
+    ASSERT_EQ(seen.size(), imsis.size());
+    for (size_t i = 0; i < imsis.size(); ++i) {
+        EXPECT_EQ(seen[i].has_value(), i % 2 == 0) << i;
+        if (seen[i]) {
+            EXPECT_LE(*seen[i], before);
+        }
+    }
+    EXPECT_TRUE(manager.last_seen_batch({}).empty());
+}
+
+TEST(SessionManagerTest, NextExpiry) {
+    std::set<std::string> blacklist;
+    pgw::SessionManager manager(30, blacklist, 100);
+    EXPECT_FALSE(manager.next_expiry());
+    
+    const auto before = std::chrono::steady_clock::now();
+    manager.try_create_session(pgw::Imsi("001010000000001"));
+    std::this_thread::sleep_for(5ms);
+    manager.try_create_session(pgw::Imsi("001010000000002"));
+    
+    // ближайшее истечение - у самой старой сессии среди всех сегментов
+    const auto next = manager.next_expiry();
+    ASSERT_TRUE(next);
+    EXPECT_GE(*next, before + 30s);
+    EXPECT_LT(*next, before + 30s + 5ms);
+    
+    manager.remove_session(pgw::Imsi("001010000000001"));
+    ASSERT_TRUE(manager.next_expiry());
+    EXPECT_GT(*manager.next_expiry(), *next);
+}
+
+TEST(SessionManagerTest, PolicyReload) {
+    std::set<std::string> blacklist{"001010000000001"};
+    pgw::SessionManager manager(30, blacklist, 3);
+    
+    EXPECT_EQ(manager.try_create_session("001010000000001"),
+              pgw::SessionManager::CreateResult::REJECTED_BLACKLIST);
+    EXPECT_EQ(manager.try_create_session("001010000000002"), pgw::SessionManager::CreateResult::CREATED);
+    EXPECT_EQ(manager.try_create_session("001010000000003"), pgw::SessionManager::CreateResult::CREATED);
+    
+    // новый черный список и лимит действуют сразу, сессии сохраняются
+    auto policy = std::make_unique<pgw::Policy>();
+    policy->blacklist = pgw::Blacklist(std::vector<std::string>{"00102*"});
+    policy->max_sessions = 2;
+    policy->session_timeout = std::chrono::seconds(1);
+    manager.set_policy(std::move(policy));
+    
+    EXPECT_EQ(manager.active_sessions(), 2u);
+    EXPECT_EQ(manager.session_timeout(), std::chrono::seconds(1));
+    EXPECT_EQ(manager.try_create_session("001020000000001"),
+              pgw::SessionManager::CreateResult::REJECTED_BLACKLIST);
+    EXPECT_EQ(manager.try_create_session("001010000000001"),
+              pgw::SessionManager::CreateResult::REJECTED_LIMIT);
+    
+    // лимит выше начального не действует: таблицы выделены на 3 сессии
+    policy = std::make_unique<pgw::Policy>();
+    policy->max_sessions = 1000;
+    policy->session_timeout = std::chrono::seconds(1);
+    manager.set_policy(std::move(policy));
+    EXPECT_EQ(manager.try_create_session("001010000000001"), pgw::SessionManager::CreateResult::CREATED);
+    EXPECT_EQ(manager.try_create_session("001010000000004"),
+              pgw::SessionManager::CreateResult::REJECTED_LIMIT);
+    
+    // новый таймаут применяется к уже созданным сессиям
+    std::this_thread::sleep_for(1100ms);
+    manager.remove_expired_sessions();
+    EXPECT_EQ(manager.active_sessions(), 0u);
+}
+
+TEST(SessionManagerTest, PolicyReloadUnderLoad) {
+    std::set<std::string> blacklist;
+    pgw::SessionManager manager(30, blacklist, 100000);
+    
+    // запросы идут, пока политика много раз меняется
+    std::atomic<bool> stop{false};
+    std::atomic<unsigned> rejected{0};
+    std::vector<std::thread> workers;
+    for (int t = 0; t < 4; ++t) {
+        workers.emplace_back([&, t] {
+            for (uint64_t i = 0; !stop; ++i) {
+                auto result = manager.try_create_session(
+                    pgw::Imsi("0010" + std::to_string(t) + std::to_string(1000000000 + i % 50000)));
+                if (result == pgw::SessionManager::CreateResult::REJECTED_BLACKLIST) rejected++;
+            }
+        });
+    }
+    for (int i = 0; i < 200; ++i) {
+        auto policy = std::make_unique<pgw::Policy>();
+        policy->blacklist = pgw::Blacklist(std::vector<std::string>{i % 2 ? "00100*" : "00101*"});
+        policy->max_sessions = 100000;
+        policy->session_timeout = std::chrono::seconds(30);
+        manager.set_policy(std::move(policy));
+        std::this_thread::sleep_for(1ms);
+    }
+    stop = true;
+    for (auto& worker : workers) worker.join();
+    
+    EXPECT_GT(rejected.load(), 0u);
+    EXPECT_EQ(manager.policy()->blacklist.prefix_count(), 1u);
+}
+
+TEST(SessionManagerTest, ReplacedPolicyReleased) {
+    pgw::SessionManager manager(30, std::set<std::string>{"001010000000001"}, 10);
+    
+    // снимок держит политику и после замены
+    auto snapshot = manager.policy();
+    std::weak_ptr<const pgw::Policy> first = snapshot;
+    manager.set_policy(std::make_unique<pgw::Policy>());
+    ASSERT_FALSE(first.expired());
+    EXPECT_EQ(snapshot->blacklist.exact_count(), 1u);
+    EXPECT_EQ(manager.policy()->blacklist.exact_count(), 0u);
+    
+    // без снимков замененная политика освобождается сразу, а не копится
+    snapshot.reset();
+    EXPECT_TRUE(first.expired());
+    std::weak_ptr<const pgw::Policy> second = manager.policy();
+    manager.set_policy(std::make_unique<pgw::Policy>());
+    EXPECT_TRUE(second.expired());
+}
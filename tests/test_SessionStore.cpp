@@ -0,0 +1,169 @@
+#include "gtest/gtest.h"
+#include "SessionManager.hpp"
+#include "SessionStore.hpp"
+#include <filesystem>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+#include <unistd.h>
+
+using namespace std::chrono_literals;
+
+class SessionStoreTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        char tmp_dir[] = "/tmp/pgw_state_XXXXXX";
+        if (!mkdtemp(tmp_dir)) {
+            throw std::runtime_error("не удалось создать временный каталог");
+        }
+        dir = tmp_dir;
+        options.dir = dir;
+        options.snapshot_interval_sec = 0;
+        options.flush_interval_ms = 10;
+    }
+    
+    void TearDown() override {
+        std::filesystem::remove_all(dir);
+    }
+    
+    std::string dir;
+    pgw::SessionStoreOptions options;
+    std::set<std::string> blacklist;
+};
+
+TEST_F(SessionStoreTest, SnapshotRoundTrip) {
+    {
+        pgw::SessionManager manager(30, blacklist, 100);
+        manager.try_create_session("111111");
+        pgw::SessionStore store(manager, options);
+        store.recover(30s);
+        store.start();
+        
+        // изменения после start() идут в журнал, при остановке - снимок
+        manager.try_create_session("222222");
+        manager.try_create_session("333333");
+        manager.remove_session("222222");
+        store.stop();
+        EXPECT_EQ(store.journaled(), 3u);
+    }
+    
+    pgw::SessionManager restored(30, blacklist, 100);
+    pgw::SessionStore store(restored, options);
+    EXPECT_EQ(store.recover(30s), 2u);
+    EXPECT_TRUE(restored.is_active("111111"));
+    EXPECT_FALSE(restored.is_active("222222"));
+    EXPECT_TRUE(restored.is_active("333333"));
+    EXPECT_EQ(restored.active_sessions(), 2u);
+}
+
+TEST_F(SessionStoreTest, JournalReplayAfterCrash) {
+    const std::string crashed = dir + "/crashed";
+    {
+        pgw::SessionManager manager(30, blacklist, 100);
+        pgw::SessionStore store(manager, options);
+        store.recover(30s);
+        store.start();
+        manager.try_create_session("111111");
+        manager.try_create_session("222222");
+        manager.remove_session("111111");
+        
+        // ждем записи журнала и копируем каталог до финального снимка,
+        // как будто процесс упал
+        for (int i = 0; i < 100 && store.journaled() < 3; ++i) {
+            std::this_thread::sleep_for(10ms);
+        }
+        ASSERT_EQ(store.journaled(), 3u);
+        std::filesystem::create_directory(crashed);
+        for (const auto& entry : std::filesystem::directory_iterator(dir)) {
+            if (entry.is_regular_file()) {
+                std::filesystem::copy_file(entry.path(), crashed / entry.path().filename());
+            }
+        }
+    }
+    
+    pgw::SessionManager restored(30, blacklist, 100);
+    options.dir = crashed;
+    pgw::SessionStore store(restored, options);
+    EXPECT_EQ(store.recover(30s), 1u);
+    EXPECT_FALSE(restored.is_active("111111"));
+    EXPECT_TRUE(restored.is_active("222222"));
+}
+
+TEST_F(SessionStoreTest, PreservesRemainingTimeout) {
+    {
+        pgw::SessionManager manager(30, blacklist, 100);
+        pgw::SessionStore store(manager, options);
+        store.start();
+        manager.try_create_session("111111");
+        std::this_thread::sleep_for(1200ms);
+        manager.try_create_session("222222");
+        store.stop();
+    }
+    
+    // 111111 простаивает дольше секунды - истекла, пока сервер лежал
+    pgw::SessionManager restored(1, blacklist, 100);
+    pgw::SessionStore store(restored, options);
+    EXPECT_EQ(store.recover(1s), 1u);
+    EXPECT_FALSE(restored.is_active("111111"));
+    EXPECT_TRUE(restored.is_active("222222"));
+    
+    // оставшийся таймаут переносится: сессия истекает в свой срок
+    std::this_thread::sleep_for(1100ms);
+    restored.remove_expired_sessions();
+    EXPECT_EQ(restored.active_sessions(), 0u);
+}
+
+TEST_F(SessionStoreTest, StartDoesNotLeaveEmptyJournal) {
+    pgw::SessionManager manager(30, blacklist, 100);
+    pgw::SessionStore store(manager, options);
+    store.recover(30s);
+    store.start();
+    
+    // снимок и журнал одного поколения, лишних журналов нет
+    EXPECT_EQ(store.generation(), 1u);
+    std::vector<std::string> journals;
+    for (const auto& entry : std::filesystem::directory_iterator(dir)) {
+        const auto name = entry.path().filename().string();
+        if (name.rfind("journal.", 0) == 0) journals.push_back(name);
+    }
+    EXPECT_EQ(journals, std::vector<std::string>{"journal.1"});
+}
+
+TEST_F(SessionStoreTest, RemovalsSurviveFullQueue) {
+    const std::string crashed = dir + "/crashed";
+    constexpr int kSessions = 500;
+    {
+        pgw::SessionManager manager(30, blacklist, 1000);
+        for (int i = 0; i < kSessions; ++i) {
+            manager.try_create_session(pgw::Imsi::parse(std::to_string(100000 + i)).value());
+        }
+        // очередь на 4 записи: удаления идут быстрее, чем пишется журнал
+        options.queue_size = 4;
+        options.flush_interval_ms = 1000;
+        pgw::SessionStore store(manager, options);
+        store.start();  // все сессии в снимке
+        for (int i = 0; i < kSessions; ++i) {
+            manager.remove_session(pgw::Imsi::parse(std::to_string(100000 + i)).value());
+        }
+        for (int i = 0; i < 300 && store.journaled() < kSessions; ++i) {
+            std::this_thread::sleep_for(10ms);
+        }
+        EXPECT_EQ(store.journaled(), static_cast<uint64_t>(kSessions));
+        EXPECT_EQ(store.dropped(), 0u);
+        
+        // падение до финального снимка: удаленные сессии не должны вернуться
+        std::filesystem::create_directory(crashed);
+        for (const auto& entry : std::filesystem::directory_iterator(dir)) {
+            if (entry.is_regular_file()) {
+                std::filesystem::copy_file(entry.path(), crashed / entry.path().filename());
+            }
+        }
+    }
+    
+    pgw::SessionManager restored(30, blacklist, 1000);
+    options.dir = crashed;
+    pgw::SessionStore store(restored, options);
+    EXPECT_EQ(store.recover(30s), 0u);
+    EXPECT_EQ(restored.active_sessions(), 0u);
+}
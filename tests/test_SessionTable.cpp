@@ -0,0 +1,122 @@
+#include "gtest/gtest.h"
+#include "SessionTable.hpp"
+#include <algorithm>
+#include <deque>
+#include <random>
+#include <set>
+#include <string>
+
+namespace {
+
+pgw::Imsi make_imsi(unsigned n) {
+    return pgw::Imsi("00101" + std::to_string(1000000000u + n));
+}
+
+} // namespace
+
+TEST(SessionTableTest, InsertFindErase) {
+    pgw::SessionTable table(64);
+    const auto now = pgw::SessionTable::Clock::now();
+    
+    EXPECT_TRUE(table.insert(make_imsi(1), now));
+    EXPECT_FALSE(table.insert(make_imsi(1), now));  // дубликат
+    EXPECT_TRUE(table.contains(make_imsi(1)));
+    EXPECT_FALSE(table.contains(make_imsi(2)));
+    
+    EXPECT_TRUE(table.erase(make_imsi(1)));
+    EXPECT_FALSE(table.erase(make_imsi(1)));
+    EXPECT_EQ(table.size(), 0u);
+    EXPECT_TRUE(table.empty());
+}
+
+TEST(SessionTableTest, TouchUpdatesLastSeen) {
+    pgw::SessionTable table(64);
+    const auto start = pgw::SessionTable::Clock::now();
+    
+    table.insert(make_imsi(1), start);
+    table.insert(make_imsi(2), start);
+    EXPECT_EQ(table.front(), make_imsi(1));
+    
+    // продленная запись уходит в хвост, голова - следующая по давности
+    EXPECT_TRUE(table.touch(make_imsi(1), start + std::chrono::seconds(5)));
+    EXPECT_FALSE(table.touch(make_imsi(3), start));
+    EXPECT_EQ(table.front(), make_imsi(2));
+    table.pop_front();
+    EXPECT_EQ(table.front(), make_imsi(1));
+    EXPECT_EQ(table.front_last_seen(), start + std::chrono::seconds(5));
+}
+
+TEST(SessionTableTest, FixedCapacity) {
+    pgw::SessionTable table(16);
+    const auto now = pgw::SessionTable::Clock::now();
+    
+    // заполнение ограничено 7/8 емкости, таблица не растет
+    unsigned inserted = 0;
+    for (unsigned i = 0; i < 32; ++i) {
+        if (table.insert(make_imsi(i), now)) inserted++;
+    }
+    EXPECT_EQ(inserted, 14u);
+    EXPECT_EQ(table.capacity(), 16u);
+}
+
+TEST(SessionTableTest, RandomOpsMatchReference) {
+    // сравниваем с эталоном: множество ключей и порядок активности
+    pgw::SessionTable table(1024);
+    std::set<uint64_t> keys;
+    std::deque<pgw::Imsi> order;
+    std::mt19937 rng(42);
+    const auto now = pgw::SessionTable::Clock::now();
+    
+    for (int step = 0; step < 20000; ++step) {
+        auto imsi = make_imsi(rng() % 2000);
+        switch (rng() % 4) {
+            case 0:
+            case 1: {
+                bool expected = keys.size() < 896 && !keys.count(imsi.raw());
+                ASSERT_EQ(table.insert(imsi, now), expected);
+                if (expected) {
+                    keys.insert(imsi.raw());
+                    order.push_back(imsi);
+                }
+                break;
+            }
+            case 2: {
+                // touch переносит запись в конец списка
+                bool expected = keys.count(imsi.raw()) > 0;
+                ASSERT_EQ(table.touch(imsi, now), expected);
+                if (expected) {
+                    order.erase(std::find(order.begin(), order.end(), imsi));
+                    order.push_back(imsi);
+                }
+                break;
+            }
+            default: {
+                bool expected = keys.erase(imsi.raw()) > 0;
+                ASSERT_EQ(table.erase(imsi), expected);
+                if (expected) {
+                    order.erase(std::find(order.begin(), order.end(), imsi));
+                }
+            }
+        }
+        ASSERT_EQ(table.size(), keys.size());
+    }
+    
+    for (uint64_t key : keys) {
+        EXPECT_TRUE(table.contains(pgw::Imsi::from_raw(key)));
+    }
+    
+    // список истечения хранит порядок активности после всех сдвигов
+    std::deque<pgw::Imsi> listed;
+    table.for_each([&](pgw::Imsi imsi, pgw::SessionTable::Clock::time_point) {
+        listed.push_back(imsi);
+        return true;
+    });
+    EXPECT_EQ(listed, order);
+    
+    while (!table.empty()) {
+        EXPECT_EQ(table.front(), order.front());
+        table.pop_front();
+        order.pop_front();
+    }
+    EXPECT_EQ(table.size(), 0u);
+}
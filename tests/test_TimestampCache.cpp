@@ -0,0 +1,44 @@
+#include <gtest/gtest.h>
+#include <chrono>
+#include <cstdlib>
+#include <ctime>
+#include <string>
+#include "TimestampCache.hpp"
+
+namespace {
+
+// ожидаемая строка, посчитанная напрямую через localtime_r
+std::string reference(std::time_t seconds) {
+    std::tm local{};
+    localtime_r(&seconds, &local);
+    char text[32];
+    return std::string(text, std::strftime(text, sizeof(text), "%Y-%m-%d %H:%M:%S", &local));
+}
+
+} // namespace
+
+TEST(TimestampCacheTest, MatchesStrftime) {
+    pgw::TimestampCache cache;
+    const int64_t base = 1760000000;
+    
+    EXPECT_EQ(cache.format(base * 1000000000 + 999999999), reference(base));
+    // смена секунды обновляет кеш
+    EXPECT_EQ(cache.format((base + 1) * 1000000000), reference(base + 1));
+    // возврат назад во времени тоже
+    EXPECT_EQ(cache.format((base - 3600) * 1000000000), reference(base - 3600));
+}
+
+TEST(TimestampCacheTest, MillisecondSuffix) {
+    pgw::TimestampCache cache(true);
+    const int64_t base = 1760000000;
+    
+    EXPECT_EQ(cache.format(base * 1000000000 + 7000000), reference(base) + ".007");
+    EXPECT_EQ(cache.format(base * 1000000000 + 123999999), reference(base) + ".123");
+    EXPECT_EQ(cache.format((base + 1) * 1000000000), reference(base + 1) + ".000");
+}
+
+TEST(TimestampCacheTest, CoarseClockIsCloseToSystemClock) {
+    const int64_t coarse = pgw::TimestampCache::coarse_now_ns();
+    const int64_t precise = std::chrono::system_clock::now().time_since_epoch() / std::chrono::nanoseconds(1);
+    EXPECT_LT(std::llabs(precise - coarse), 100000000);  // в пределах 100 мс
+}
@@ -2,6 +2,7 @@
 #include "UdpServer.hpp"
 #include "SessionManager.hpp"
 #include "CDRLogger.hpp"
+#include "Gtpv2.hpp"
 #include <thread>
 #include <netinet/in.h>
 #include <arpa/inet.h>
@@ -14,7 +15,10 @@
 
 using namespace std::chrono_literals;
 
-class UdpServerTest : public ::testing::Test {
+// все сценарии прогоняются для каждого способа приема. IO_URING без
+// PGW_WITH_IO_URING пропускается, а в сборке с ним обязан работать через
+// io_uring - молчаливый откат на epoll считается ошибкой
+class UdpServerTest : public ::testing::TestWithParam<pgw::UdpBackend> {
 protected:
     void SetUp() override {
         // создаем временный файл безопасно
@@ -31,7 +35,8 @@ protected:
         cdr_logger = std::make_unique<pgw::CDRLogger>(cdr_file);
         
         // запускаем сервер и получаем реальный порт
-        server = std::make_unique<pgw::UdpServer>("127.0.0.1", 0, *session_manager, *cdr_logger);
+        server = std::make_unique<pgw::UdpServer>("127.0.0.1", 0, *session_manager, *cdr_logger,
+                                                  1, false, nullptr, GetParam());
         actual_port = server->port();
         
         // запускаем сервер в потоке
@@ -41,6 +46,19 @@ protected:
         
         // ждем запуска сервера
         std::this_thread::sleep_for(100ms);
+        for (int i = 0; i < 100 && !server->active_backend(); ++i) {
+            std::this_thread::sleep_for(10ms);
+        }
+        ASSERT_TRUE(server->active_backend()) << "сервер не запустился";
+        
+        if (GetParam() == pgw::UdpBackend::IO_URING) {
+#ifdef PGW_WITH_IO_URING
+            ASSERT_EQ(*server->active_backend(), pgw::UdpBackend::IO_URING)
+                << "io_uring недоступен, сервер откатился на epoll";
+#else
+            GTEST_SKIP() << "сервер собран без PGW_WITH_IO_URING";
+#endif
+        }
     }
     
     void TearDown() override {
@@ -75,7 +93,13 @@ protected:
     uint16_t actual_port; // реальный порт сервера
 };
 
-TEST_F(UdpServerTest, BasicRequest) {
+INSTANTIATE_TEST_SUITE_P(Backends, UdpServerTest,
+    ::testing::Values(pgw::UdpBackend::EPOLL, pgw::UdpBackend::IO_URING),
+    [](const ::testing::TestParamInfo<pgw::UdpBackend>& info) {
+        return std::string(info.param == pgw::UdpBackend::IO_URING ? "IoUring" : "Epoll");
+    });
+
+TEST_P(UdpServerTest, BasicRequest) {
     // создаем клиентский сокет
     int client_sock = create_client_socket();
     
@@ -118,7 +142,7 @@ TEST_F(UdpServerTest, BasicRequest) {
     EXPECT_TRUE(session_manager->is_active(imsi));
 }
 
-TEST_F(UdpServerTest, BlacklistedRequest) {
+TEST_P(UdpServerTest, BlacklistedRequest) {
     int client_sock = create_client_socket();
     sockaddr_in server_addr{};
     server_addr.sin_family = AF_INET;
@@ -152,4 +176,189 @@ TEST_F(UdpServerTest, BlacklistedRequest) {
     std::string response(buffer, received);
     EXPECT_EQ(response, "rejected");
     EXPECT_FALSE(session_manager->is_active(imsi));
-}
\ No newline at end of file
+}
+
+TEST(UdpServerBatchTest, BatchedRequests) {
+    char tmp_file[] = "/tmp/pgw_test_XXXXXX";
+    int fd = mkstemp(tmp_file);
+    ASSERT_NE(fd, -1);
+    close(fd);
+    
+    std::set<std::string> blacklist = {"123456"};
+    pgw::SessionManager session_manager(30, blacklist, 100);
+    pgw::CDRLogger cdr_logger(tmp_file);
+    
+    // сервер в пакетном режиме recvmmsg/sendmmsg
+    pgw::UdpServer server("127.0.0.1", 0, session_manager, cdr_logger, 8);
+    std::thread server_thread([&server] { server.run(); });
+    std::this_thread::sleep_for(100ms);
+    
+    int client_sock = socket(AF_INET, SOCK_DGRAM, 0);
+    ASSERT_GE(client_sock, 0);
+    struct timeval tv{0, 500000};
+    setsockopt(client_sock, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+    
+    sockaddr_in server_addr{};
+    server_addr.sin_family = AF_INET;
+    server_addr.sin_port = htons(server.port());
+    inet_pton(AF_INET, "127.0.0.1", &server_addr.sin_addr);
+    
+    // отправляем пачку запросов, не дожидаясь ответов
+    const std::vector<std::string> imsis = {
+        "100000000000001", "100000000000002", "123456", "100000000000003"
+    };
+    for (const auto& imsi : imsis) {
+        sendto(client_sock, imsi.c_str(), imsi.size(), 0,
+               (sockaddr*)&server_addr, sizeof(server_addr));
+    }
+    
+    // ответы приходят в порядке запросов
+    std::vector<std::string> responses;
+    for (size_t i = 0; i < imsis.size(); ++i) {
+        char buffer[16] = {0};
+        ssize_t received = recv(client_sock, buffer, sizeof(buffer), 0);
+        if (received <= 0) break;
+        responses.emplace_back(buffer, received);
+    }
+    close(client_sock);
+    
+    server.stop();
+    server_thread.join();
+    std::remove(tmp_file);
+    
+    ASSERT_EQ(responses.size(), imsis.size());
+    EXPECT_EQ(responses[0], "created");
+    EXPECT_EQ(responses[1], "created");
+    EXPECT_EQ(responses[2], "rejected");
+    EXPECT_EQ(responses[3], "created");
+    EXPECT_EQ(session_manager.active_sessions(), 3);
+}
+
+TEST_P(UdpServerTest, BinaryMultiImsiRequest) {
+    int client_sock = create_client_socket();
+    sockaddr_in server_addr{};
+    server_addr.sin_family = AF_INET;
+    server_addr.sin_port = htons(actual_port);
+    inet_pton(AF_INET, "127.0.0.1", &server_addr.sin_addr);
+    
+    // один пакет: новая сессия, она же повторно, черный список
+    session_manager->try_create_session("111222333444000");
+    const std::string packet = pgw::encode_request(42, {
+        pgw::Imsi("111222333444555"), pgw::Imsi("111222333444000"), pgw::Imsi("123456")
+    });
+    sendto(client_sock, packet.data(), packet.size(), 0, (sockaddr*)&server_addr, sizeof(server_addr));
+    
+    char buffer[pgw::kMaxResponseSize] = {0};
+    ssize_t received = recv(client_sock, buffer, sizeof(buffer), 0);
+    ASSERT_GT(received, 0) << "ответ не получен: " << strerror(errno);
+    
+    std::string_view reply(buffer, received);
+    auto header = pgw::decode_header(reply);
+    ASSERT_TRUE(header.has_value());
+    EXPECT_EQ(header->type, pgw::PacketType::CREATE_RESPONSE);
+    EXPECT_EQ(header->seq, 42u);
+    ASSERT_EQ(header->count, 3);
+    EXPECT_EQ(static_cast<pgw::ResultCode>(reply[8]), pgw::ResultCode::CREATED);
+    EXPECT_EQ(static_cast<pgw::ResultCode>(reply[9]), pgw::ResultCode::EXISTS);
+    EXPECT_EQ(static_cast<pgw::ResultCode>(reply[10]), pgw::ResultCode::REJECTED_BLACKLIST);
+    EXPECT_TRUE(session_manager->is_active("111222333444555"));
+    
+    // битый пакет отбрасывается без ответа, текстовый протокол продолжает работать
+    sendto(client_sock, packet.data(), packet.size() - 1, 0, (sockaddr*)&server_addr, sizeof(server_addr));
+    const std::string imsi = "111222333444666";
+    sendto(client_sock, imsi.data(), imsi.size(), 0, (sockaddr*)&server_addr, sizeof(server_addr));
+    received = recv(client_sock, buffer, sizeof(buffer), 0);
+    close(client_sock);
+    ASSERT_GT(received, 0);
+    EXPECT_EQ(std::string(buffer, received), "created");
+}
+
+TEST_P(UdpServerTest, DeleteAndRefreshRequests) {
+    int client_sock = create_client_socket();
+    sockaddr_in server_addr{};
+    server_addr.sin_family = AF_INET;
+    server_addr.sin_port = htons(actual_port);
+    inet_pton(AF_INET, "127.0.0.1", &server_addr.sin_addr);
+    
+    auto exchange = [&](const std::string& request) {
+        sendto(client_sock, request.data(), request.size(), 0, (sockaddr*)&server_addr, sizeof(server_addr));
+        char buffer[pgw::kMaxResponseSize];
+        ssize_t received = recv(client_sock, buffer, sizeof(buffer), 0);
+        return received > 0 ? std::string(buffer, received) : std::string();
+    };
+    
+    // текстовые команды
+    EXPECT_EQ(exchange("111222333444555"), "created");
+    EXPECT_EQ(exchange("refresh 111222333444555"), "refreshed");
+    EXPECT_EQ(exchange("delete 111222333444555"), "deleted");
+    EXPECT_FALSE(session_manager->is_active("111222333444555"));
+    EXPECT_EQ(exchange("delete 111222333444555"), "not_found");
+    EXPECT_EQ(exchange("refresh 111222333444555"), "not_found");
+    EXPECT_EQ(exchange("delete abc"), "rejected");
+    
+    // бинарное удаление: тип ответа - тип запроса + 1
+    session_manager->try_create_session("111222333444000");
+    const std::string reply = exchange(pgw::encode_request(
+        3, {pgw::Imsi("111222333444000"), pgw::Imsi("111222333444555")}, pgw::PacketType::DELETE_REQUEST));
+    close(client_sock);
+    auto header = pgw::decode_header(reply);
+    ASSERT_TRUE(header.has_value());
+    EXPECT_EQ(header->type, pgw::PacketType::DELETE_RESPONSE);
+    ASSERT_EQ(header->count, 2);
+    EXPECT_EQ(static_cast<pgw::ResultCode>(reply[8]), pgw::ResultCode::DELETED);
+    EXPECT_EQ(static_cast<pgw::ResultCode>(reply[9]), pgw::ResultCode::NOT_FOUND);
+    EXPECT_EQ(session_manager->active_sessions(), 0);
+}
+
+TEST_P(UdpServerTest, GtpCreateDeleteSession) {
+    int client_sock = create_client_socket();
+    sockaddr_in server_addr{};
+    server_addr.sin_family = AF_INET;
+    server_addr.sin_port = htons(actual_port);
+    inet_pton(AF_INET, "127.0.0.1", &server_addr.sin_addr);
+    
+    auto exchange = [&](std::string_view request, char* buffer) {
+        sendto(client_sock, request.data(), request.size(), 0, (sockaddr*)&server_addr, sizeof(server_addr));
+        ssize_t received = recv(client_sock, buffer, pgw::kMaxResponseSize, 0);
+        return received > 0 ? pgw::GtpMessage::parse(std::string_view(buffer, received)) : std::nullopt;
+    };
+    
+    // Create Session Request с Sender F-TEID 0x1234
+    char request[128];
+    pgw::GtpWriter csr(request, sizeof(request), pgw::GtpMessageType::CREATE_SESSION_REQUEST, 0u, 5);
+    csr.add_imsi(pgw::Imsi("001010123456789"));
+    csr.add_fteid(0, 6, 0x1234, 0x0100007F);
+    
+    char buffer[pgw::kMaxResponseSize];
+    auto response = exchange(csr.finish(), buffer);
+    ASSERT_TRUE(response.has_value());
+    EXPECT_EQ(response->type(), 33);
+    EXPECT_EQ(response->teid(), 0x1234u);
+    EXPECT_EQ(response->sequence(), 5u);
+    auto cause = response->find_ie(pgw::GtpIeType::CAUSE);
+    ASSERT_TRUE(cause.has_value());
+    EXPECT_EQ(static_cast<uint8_t>(cause->value[0]), 16);
+    auto our_teid = response->fteid_teid(0);
+    ASSERT_TRUE(our_teid.has_value());
+    EXPECT_TRUE(session_manager->is_active("001010123456789"));
+    
+    // Delete Session Request на выданный TEID
+    pgw::GtpWriter dsr(request, sizeof(request), pgw::GtpMessageType::DELETE_SESSION_REQUEST, *our_teid, 6);
+    response = exchange(dsr.finish(), buffer);
+    ASSERT_TRUE(response.has_value());
+    EXPECT_EQ(response->type(), 37);
+    EXPECT_EQ(response->teid(), 0x1234u);
+    cause = response->find_ie(pgw::GtpIeType::CAUSE);
+    ASSERT_TRUE(cause.has_value());
+    EXPECT_EQ(static_cast<uint8_t>(cause->value[0]), 16);
+    EXPECT_FALSE(session_manager->is_active("001010123456789"));
+    
+    // повторное удаление - контекст не найден
+    pgw::GtpWriter again(request, sizeof(request), pgw::GtpMessageType::DELETE_SESSION_REQUEST, *our_teid, 7);
+    response = exchange(again.finish(), buffer);
+    close(client_sock);
+    ASSERT_TRUE(response.has_value());
+    cause = response->find_ie(pgw::GtpIeType::CAUSE);
+    ASSERT_TRUE(cause.has_value());
+    EXPECT_EQ(static_cast<uint8_t>(cause->value[0]), 64);
+}
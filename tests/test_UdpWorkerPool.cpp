@@ -0,0 +1,87 @@
+#include "gtest/gtest.h"
+#include "UdpWorkerPool.hpp"
+#include "SessionManager.hpp"
+#include "CDRLogger.hpp"
+#include <thread>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <unistd.h>
+#include <chrono>
+#include <set>
+#include <string>
+#include <vector>
+
+using namespace std::chrono_literals;
+
+class UdpWorkerPoolTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        char tmp_file[] = "/tmp/pgw_test_XXXXXX";
+        int fd = mkstemp(tmp_file);
+        if (fd == -1) {
+            throw std::runtime_error("не удалось создать временный файл");
+        }
+        close(fd);
+        cdr_file = tmp_file;
+        
+        session_manager = std::make_unique<pgw::SessionManager>(30, blacklist, 100);
+        cdr_logger = std::make_unique<pgw::CDRLogger>(cdr_file);
+    }
+    
+    void TearDown() override {
+        std::remove(cdr_file.c_str());
+    }
+    
+    // отправляем IMSI с нового сокета (новый порт источника -> другой хеш SO_REUSEPORT)
+    std::string send_request(uint16_t port, const std::string& imsi) {
+        int sock = socket(AF_INET, SOCK_DGRAM, 0);
+        struct timeval tv{0, 500000};
+        setsockopt(sock, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+        
+        sockaddr_in server_addr{};
+        server_addr.sin_family = AF_INET;
+        server_addr.sin_port = htons(port);
+        inet_pton(AF_INET, "127.0.0.1", &server_addr.sin_addr);
+        
+        sendto(sock, imsi.c_str(), imsi.size(), 0,
+               (sockaddr*)&server_addr, sizeof(server_addr));
+        
+        char buffer[16] = {0};
+        ssize_t received = recv(sock, buffer, sizeof(buffer), 0);
+        close(sock);
+        return received > 0 ? std::string(buffer, received) : "";
+    }
+    
+    std::string cdr_file;
+    std::set<std::string> blacklist = {"123456"};
+    std::unique_ptr<pgw::SessionManager> session_manager;
+    std::unique_ptr<pgw::CDRLogger> cdr_logger;
+};
+
+TEST_F(UdpWorkerPoolTest, WorkersShareSessions) {
+    pgw::UdpWorkerPool pool("127.0.0.1", 0, 4, *session_manager, *cdr_logger, 8);
+    EXPECT_EQ(pool.size(), 4u);
+    ASSERT_NE(pool.port(), 0);
+    
+    pool.start();
+    std::this_thread::sleep_for(100ms);
+    
+    // запросы с разных сокетов распределяются по воркерам
+    for (int i = 0; i < 16; ++i) {
+        EXPECT_EQ(send_request(pool.port(), "1000000000000" + std::to_string(10 + i)), "created");
+    }
+    EXPECT_EQ(send_request(pool.port(), "123456"), "rejected");
+    EXPECT_EQ(session_manager->active_sessions(), 16u);
+    
+    pool.stop();
+}
+
+TEST_F(UdpWorkerPoolTest, StopBeforeTraffic) {
+    pgw::UdpWorkerPool pool("127.0.0.1", 0, 2, *session_manager, *cdr_logger);
+    pool.start();
+    
+    // stop() должен разбудить всех воркеров, даже если они еще не дошли до recvfrom
+    auto started = std::chrono::steady_clock::now();
+    pool.stop();
+    EXPECT_LT(std::chrono::steady_clock::now() - started, 1s);
+}